@@ -0,0 +1,242 @@
+#include "../pch.h"
+
+using namespace std;
+
+namespace halo2 {
+    namespace circuit {
+
+        namespace {
+            typedef XorwowGateValue V;
+
+            const V TWO_64 = V(1) << 64;
+
+            inline V cell(const XorwowTrace &trace, XorwowColumn column, size_t row) {
+                return trace.field(column, row);
+            }
+
+            // gate for "column at the next row is a copy of from at this row"
+            template <XorwowColumn column, XorwowColumn from>
+            V transition(const XorwowTrace &trace, const XorwowInstance &, size_t row) {
+                return cell(trace, column, row + 1) - cell(trace, from, row);
+            }
+
+            // gate for "column at the first row is the public initial state word i"
+            template <XorwowColumn column, size_t i>
+            V initial(const XorwowTrace &trace, const XorwowInstance &instance, size_t row) {
+                return cell(trace, column, row) - V(instance.initialState[i]);
+            }
+
+            // gate for "the limb columns of XORWOW_LIMBED_COLUMNS[slot] recompose its cell"
+            template <size_t slot>
+            V recompose(const XorwowTrace &trace, const XorwowInstance &, size_t row) {
+                const XorwowColumn column = XORWOW_LIMBED_COLUMNS[slot];
+                V sum = 0;
+                for (unsigned j = 0; j < XORWOW_CELL_LIMBS; j++) {
+                    sum += V(trace.limb(column, j, row)) << (8 * j);
+                }
+                return cell(trace, column, row) - sum;
+            }
+
+            const char *const COLUMN_NAMES[XORWOW_NUM_COLUMNS] = {
+                    "x0", "x1", "x2", "x3", "x4", "counter",
+                    "t_shr2", "t_shr2_rem", "t1", "t1_shl1", "t1_shl1_hi", "t2",
+                    "s_shl4", "s_shl4_hi", "u", "t3",
+                    "counter_next", "counter_carry", "out", "out_carry"
+            };
+        }
+
+        void XorwowTrace::assign(XorwowColumn column, size_t row, const XorwowGateValue &value) {
+            if (value >= 0 && value <= numeric_limits<uint64_t>::max()) {
+                columns[column][row] = value.convert_to<uint64_t>();
+                wideCells.erase({column, row});
+            } else {
+                columns[column][row] = 0;
+                wideCells[{column, row}] = value;
+            }
+        }
+
+        XorwowInstance::XorwowInstance(uint64_t seed, vector<uint64_t> outputs) : outputs(move(outputs)) {
+            XORWOW_STATE state = XorwowWitnessGenerator::initialState(seed);
+            copy(begin(state.x), end(state.x), initialState.begin());
+            initialState[5] = state.counter;
+        }
+
+        const XorwowGateValue &XorwowCircuit::modulus() {
+            static const XorwowGateValue q("0x40000000000000000000000000000000224698fc0994a8dd8c46eb2100000001");
+            return q;
+        }
+
+        const char *XorwowCircuit::columnName(XorwowColumn column) {
+            return column < XORWOW_NUM_COLUMNS ? COLUMN_NAMES[column] : "unknown";
+        }
+
+        const vector<XorwowGate> &XorwowCircuit::gates() {
+            static const vector<XorwowGate> gates = {
+                    // t = (t >> 2) * 4 + rem
+                    {"t_shr2", XORWOW_ROWS_ALL, [](const XorwowTrace &tr, const XorwowInstance &, size_t r) -> V {
+                        return cell(tr, XORWOW_COL_X4, r) -
+                               (cell(tr, XORWOW_COL_T_SHR2, r) * 4 + cell(tr, XORWOW_COL_T_SHR2_REM, r));
+                    }},
+                    // t1 = hi * 2^63 + lo and t1 << 1 = lo * 2
+                    {"t1_shl1", XORWOW_ROWS_ALL, [](const XorwowTrace &tr, const XorwowInstance &, size_t r) -> V {
+                        V lo = cell(tr, XORWOW_COL_T1, r) - (cell(tr, XORWOW_COL_T1_SHL1_HI, r) << 63);
+                        return cell(tr, XORWOW_COL_T1_SHL1, r) - lo * 2;
+                    }},
+                    // s = hi * 2^60 + lo and s << 4 = lo * 16
+                    {"s_shl4", XORWOW_ROWS_ALL, [](const XorwowTrace &tr, const XorwowInstance &, size_t r) -> V {
+                        V lo = cell(tr, XORWOW_COL_X0, r) - (cell(tr, XORWOW_COL_S_SHL4_HI, r) << 60);
+                        return cell(tr, XORWOW_COL_S_SHL4, r) - lo * 16;
+                    }},
+                    // a boolean gate, a range lookup of a 1-bit cell would need a second table
+                    {"t1_shl1_hi_bool", XORWOW_ROWS_ALL, [](const XorwowTrace &tr, const XorwowInstance &, size_t r) -> V {
+                        V hi = cell(tr, XORWOW_COL_T1_SHL1_HI, r);
+                        return hi * (1 - hi);
+                    }},
+                    {"counter_carry_bool", XORWOW_ROWS_ALL, [](const XorwowTrace &tr, const XorwowInstance &, size_t r) -> V {
+                        V c = cell(tr, XORWOW_COL_COUNTER_CARRY, r);
+                        return c * (1 - c);
+                    }},
+                    {"counter_next", XORWOW_ROWS_ALL, [](const XorwowTrace &tr, const XorwowInstance &, size_t r) -> V {
+                        return cell(tr, XORWOW_COL_COUNTER_NEXT, r) -
+                               (cell(tr, XORWOW_COL_COUNTER, r) + V(COUNTER_INCREMENT) -
+                                cell(tr, XORWOW_COL_COUNTER_CARRY, r) * TWO_64);
+                    }},
+                    {"out_carry_bool", XORWOW_ROWS_ALL, [](const XorwowTrace &tr, const XorwowInstance &, size_t r) -> V {
+                        V c = cell(tr, XORWOW_COL_OUT_CARRY, r);
+                        return c * (1 - c);
+                    }},
+                    {"out", XORWOW_ROWS_ALL, [](const XorwowTrace &tr, const XorwowInstance &, size_t r) -> V {
+                        return cell(tr, XORWOW_COL_OUT, r) -
+                               (cell(tr, XORWOW_COL_T3, r) + cell(tr, XORWOW_COL_COUNTER_NEXT, r) -
+                                cell(tr, XORWOW_COL_OUT_CARRY, r) * TWO_64);
+                    }},
+                    {"next_x0", XORWOW_ROWS_ALL_BUT_LAST, transition<XORWOW_COL_X0, XORWOW_COL_T3>},
+                    {"next_x1", XORWOW_ROWS_ALL_BUT_LAST, transition<XORWOW_COL_X1, XORWOW_COL_X0>},
+                    {"next_x2", XORWOW_ROWS_ALL_BUT_LAST, transition<XORWOW_COL_X2, XORWOW_COL_X1>},
+                    {"next_x3", XORWOW_ROWS_ALL_BUT_LAST, transition<XORWOW_COL_X3, XORWOW_COL_X2>},
+                    {"next_x4", XORWOW_ROWS_ALL_BUT_LAST, transition<XORWOW_COL_X4, XORWOW_COL_X3>},
+                    {"next_counter", XORWOW_ROWS_ALL_BUT_LAST, transition<XORWOW_COL_COUNTER, XORWOW_COL_COUNTER_NEXT>},
+                    {"init_x0", XORWOW_ROWS_FIRST, initial<XORWOW_COL_X0, 0>},
+                    {"init_x1", XORWOW_ROWS_FIRST, initial<XORWOW_COL_X1, 1>},
+                    {"init_x2", XORWOW_ROWS_FIRST, initial<XORWOW_COL_X2, 2>},
+                    {"init_x3", XORWOW_ROWS_FIRST, initial<XORWOW_COL_X3, 3>},
+                    {"init_x4", XORWOW_ROWS_FIRST, initial<XORWOW_COL_X4, 4>},
+                    {"init_counter", XORWOW_ROWS_FIRST, initial<XORWOW_COL_COUNTER, 5>},
+                    // the output of every row is a public input
+                    {"out_instance", XORWOW_ROWS_ALL, [](const XorwowTrace &tr, const XorwowInstance &inst, size_t r) -> V {
+                        return cell(tr, XORWOW_COL_OUT, r) - V(inst.outputs[r]);
+                    }},
+                    {"x0_limbs", XORWOW_ROWS_ALL, recompose<0>},
+                    {"x4_limbs", XORWOW_ROWS_ALL, recompose<1>},
+                    {"t_shr2_limbs", XORWOW_ROWS_ALL, recompose<2>},
+                    {"t1_limbs", XORWOW_ROWS_ALL, recompose<3>},
+                    {"t1_shl1_limbs", XORWOW_ROWS_ALL, recompose<4>},
+                    {"t2_limbs", XORWOW_ROWS_ALL, recompose<5>},
+                    {"s_shl4_limbs", XORWOW_ROWS_ALL, recompose<6>},
+                    {"u_limbs", XORWOW_ROWS_ALL, recompose<7>},
+                    {"t3_limbs", XORWOW_ROWS_ALL, recompose<8>},
+                    {"counter_next_limbs", XORWOW_ROWS_ALL, recompose<9>},
+                    {"out_limbs", XORWOW_ROWS_ALL, recompose<10>},
+            };
+            return gates;
+        }
+
+        const vector<XorwowXorLookup> &XorwowCircuit::xorLookups() {
+            static const vector<XorwowXorLookup> lookups = {
+                    {"t1 = t ^ (t >> 2)", XORWOW_COL_X4, XORWOW_COL_T_SHR2, XORWOW_COL_T1},
+                    {"t2 = t1 ^ (t1 << 1)", XORWOW_COL_T1, XORWOW_COL_T1_SHL1, XORWOW_COL_T2},
+                    {"u = s ^ (s << 4)", XORWOW_COL_X0, XORWOW_COL_S_SHL4, XORWOW_COL_U},
+                    {"t3 = t2 ^ u", XORWOW_COL_T2, XORWOW_COL_U, XORWOW_COL_T3},
+            };
+            return lookups;
+        }
+
+        const vector<XorwowRangeLookup> &XorwowCircuit::rangeLookups() {
+            static const vector<XorwowRangeLookup> lookups = {
+                    {"t_shr2_rem", XORWOW_COL_T_SHR2_REM, 2},
+                    {"s_shl4_hi", XORWOW_COL_S_SHL4_HI, 4},
+                    {"counter_next", XORWOW_COL_COUNTER_NEXT, 64},
+                    {"out", XORWOW_COL_OUT, 64},
+            };
+            return lookups;
+        }
+
+        void XorwowCircuit::xorTable(vector<uint8_t> &a, vector<uint8_t> &b, vector<uint8_t> &c) {
+            a.resize(XOR_TABLE_ROWS);
+            b.resize(XOR_TABLE_ROWS);
+            c.resize(XOR_TABLE_ROWS);
+            for (size_t row = 0; row < XOR_TABLE_ROWS; row++) {
+                a[row] = static_cast<uint8_t>(row >> LIMB_BITS);
+                b[row] = static_cast<uint8_t>(row);
+                c[row] = a[row] ^ b[row];
+            }
+        }
+
+        bool XorwowCircuit::verify(const XorwowTrace &trace, const XorwowInstance &instance, string *failure) {
+            vector<uint8_t> tableA, tableB, tableC;
+            xorTable(tableA, tableB, tableC);
+
+            // the table is indexed by its two inputs, so a lookup is a single probe
+            auto inTable = [&](const V &a, const V &b, const V &c) {
+                const unsigned limb = 1u << LIMB_BITS;
+                if (a < 0 || a >= limb || b < 0 || b >= limb || c < 0 || c >= limb) {
+                    return false;
+                }
+                return tableC[(a.convert_to<size_t>() << LIMB_BITS) | b.convert_to<size_t>()] ==
+                       c.convert_to<size_t>();
+            };
+
+            auto fail = [&](const char *name, size_t row) {
+                if (failure) {
+                    *failure = string(name) + " at row " + to_string(row);
+                }
+                return false;
+            };
+
+            if (instance.outputs.size() != trace.rows) {
+                return fail("out_instance size", 0);
+            }
+
+            for (size_t row = 0; row < trace.rows; row++) {
+                for (const auto &gate : gates()) {
+                    if ((gate.rows == XORWOW_ROWS_FIRST && row != 0) ||
+                        (gate.rows == XORWOW_ROWS_ALL_BUT_LAST && row + 1 >= trace.rows)) {
+                        continue;
+                    }
+                    if (gate.eval(trace, instance, row) % modulus() != 0) {
+                        return fail(gate.name, row);
+                    }
+                }
+
+                for (const auto &lookup : xorLookups()) {
+                    for (unsigned j = 0; j < NUM_LIMBS; j++) {
+                        if (!inTable(trace.limb(lookup.lhs, j, row), trace.limb(lookup.rhs, j, row),
+                                     trace.limb(lookup.out, j, row))) {
+                            return fail(lookup.name, row);
+                        }
+                    }
+                }
+
+                for (const auto &lookup : rangeLookups()) {
+                    if (lookup.bits < LIMB_BITS) {
+                        // v < 2^bits exactly when both v and v * 2^(8 - bits) mod q are limbs
+                        V value = trace.field(lookup.column, row);
+                        V scaled = (value << (LIMB_BITS - lookup.bits)) % modulus();
+                        if (!inTable(value, 0, value) || !inTable(scaled, 0, scaled)) {
+                            return fail(lookup.name, row);
+                        }
+                    } else {
+                        for (unsigned j = 0; j < NUM_LIMBS; j++) {
+                            uint8_t l = trace.limb(lookup.column, j, row);
+                            if (!inTable(l, 0, l)) {
+                                return fail(lookup.name, row);
+                            }
+                        }
+                    }
+                }
+            }
+            return true;
+        }
+
+    } // namespace circuit
+}  // namespace halo2
@@ -0,0 +1,279 @@
+#ifndef HALO2_XORWOW_CIRCUIT_H
+#define HALO2_XORWOW_CIRCUIT_H
+
+namespace halo2 {
+    namespace circuit {
+
+        /**
+        * @brief Advice columns of the xorwow circuit. One row holds one step of the generator:
+        *        the state before the step, every intermediate of the shift/XOR network and the
+        *        output of the step.
+        */
+        enum XorwowColumn : std::size_t {
+            XORWOW_COL_X0 = 0,          ///< state word x[0] (s in xorwow::rand)
+            XORWOW_COL_X1,              ///< state word x[1]
+            XORWOW_COL_X2,              ///< state word x[2]
+            XORWOW_COL_X3,              ///< state word x[3]
+            XORWOW_COL_X4,              ///< state word x[4] (t in xorwow::rand)
+            XORWOW_COL_COUNTER,         ///< counter before the step
+            XORWOW_COL_T_SHR2,          ///< t >> 2
+            XORWOW_COL_T_SHR2_REM,      ///< t & 3, the bits shifted out by t >> 2
+            XORWOW_COL_T1,              ///< t ^ (t >> 2)
+            XORWOW_COL_T1_SHL1,         ///< t1 << 1
+            XORWOW_COL_T1_SHL1_HI,      ///< t1 >> 63, the bit shifted out by t1 << 1
+            XORWOW_COL_T2,              ///< t1 ^ (t1 << 1)
+            XORWOW_COL_S_SHL4,          ///< s << 4
+            XORWOW_COL_S_SHL4_HI,       ///< s >> 60, the bits shifted out by s << 4
+            XORWOW_COL_U,               ///< s ^ (s << 4)
+            XORWOW_COL_T3,              ///< t2 ^ u, the new x[0]
+            XORWOW_COL_COUNTER_NEXT,    ///< counter + XOR_ADD_VALUE mod 2^64
+            XORWOW_COL_COUNTER_CARRY,   ///< overflow bit of the counter addition
+            XORWOW_COL_OUT,             ///< t3 + counter_next mod 2^64, the value returned by xorwow::rand
+            XORWOW_COL_OUT_CARRY,       ///< overflow bit of the output addition
+            XORWOW_NUM_COLUMNS
+        };
+
+        /// number of cells decomposed into 8-bit limbs, the operands of the XOR and 64-bit range lookups
+        constexpr std::size_t XORWOW_NUM_LIMBED_COLUMNS = 11;
+
+        /// limbs per decomposed cell
+        constexpr unsigned XORWOW_CELL_LIMBS = 8;
+
+        /// the cells decomposed into limbs, in the order of their limb columns
+        constexpr XorwowColumn XORWOW_LIMBED_COLUMNS[XORWOW_NUM_LIMBED_COLUMNS] = {
+                XORWOW_COL_X0, XORWOW_COL_X4, XORWOW_COL_T_SHR2, XORWOW_COL_T1, XORWOW_COL_T1_SHL1,
+                XORWOW_COL_T2, XORWOW_COL_S_SHL4, XORWOW_COL_U, XORWOW_COL_T3,
+                XORWOW_COL_COUNTER_NEXT, XORWOW_COL_OUT
+        };
+
+        /**
+        * @brief Returns the position of a cell in XORWOW_LIMBED_COLUMNS, or XORWOW_NUM_LIMBED_COLUMNS
+        *        if the cell has no limb columns.
+        */
+        constexpr std::size_t xorwowLimbSlot(XorwowColumn column, std::size_t slot = 0) {
+            return slot == XORWOW_NUM_LIMBED_COLUMNS || XORWOW_LIMBED_COLUMNS[slot] == column
+                   ? slot : xorwowLimbSlot(column, slot + 1);
+        }
+
+        /// an integer representative of a field element, gate evaluations are reduced mod XorwowCircuit::modulus()
+        typedef boost::multiprecision::cpp_int XorwowGateValue;
+
+        /**
+        * @brief Witness of the xorwow circuit, stored column-major so that every column is a
+        *        contiguous array of rows.
+        *
+        * Every cell is the canonical representative of a Pallas scalar field element. In an honest
+        * witness all of them are below 2^64, so a uint64_t holds a cell exactly. The few cells a
+        * prover assigns a wider field element are kept aside in wideCells, so that the mock
+        * verifier sees every assignment a prover could make.
+        * Each cell in XORWOW_LIMBED_COLUMNS also has 8 limb advice columns, tied to the cell by a
+        * recomposition gate. Limb cells are stored as bytes, the lookups are what bound them to
+        * 8 bits in the field.
+        */
+        class XorwowTrace {
+        public:
+            std::size_t rows = 0;  ///< number of filled rows (generator steps)
+            std::array<std::vector<uint64_t>, XORWOW_NUM_COLUMNS> columns;  ///< advice columns
+            /// limb advice columns, limb j of XORWOW_LIMBED_COLUMNS[s] is at s * XORWOW_CELL_LIMBS + j
+            std::array<std::vector<uint8_t>, XORWOW_NUM_LIMBED_COLUMNS * XORWOW_CELL_LIMBS> limbs;
+            /// cells holding a field element of 2^64 or more, their entry in columns is unused
+            std::map<std::pair<XorwowColumn, std::size_t>, XorwowGateValue> wideCells;
+
+            /**
+            * @brief Resizes every column to n rows.
+            *
+            * @param n The number of rows.
+            */
+            void resize(std::size_t n) {
+                rows = n;
+                for (auto &column : columns) {
+                    column.resize(n);
+                }
+                for (auto &column : limbs) {
+                    column.resize(n);
+                }
+                for (auto it = wideCells.begin(); it != wideCells.end();) {
+                    it = it->first.second >= n ? wideCells.erase(it) : std::next(it);
+                }
+            }
+
+            inline uint64_t &at(XorwowColumn column, std::size_t row) {
+                return columns[column][row];
+            }
+
+            inline uint64_t at(XorwowColumn column, std::size_t row) const {
+                return columns[column][row];
+            }
+
+            /// returns the field element held by a cell
+            inline XorwowGateValue field(XorwowColumn column, std::size_t row) const {
+                if (!wideCells.empty()) {
+                    auto it = wideCells.find({column, row});
+                    if (it != wideCells.end()) {
+                        return it->second;
+                    }
+                }
+                return XorwowGateValue(columns[column][row]);
+            }
+
+            /**
+            * @brief Assigns any field element to a cell.
+            *
+            * @param column The column of the cell.
+            * @param row The row of the cell.
+            * @param value The canonical representative of the element, in [0, XorwowCircuit::modulus()).
+            */
+            void assign(XorwowColumn column, std::size_t row, const XorwowGateValue &value);
+
+            /// returns limb j of a decomposed cell
+            inline uint8_t &limb(XorwowColumn column, unsigned j, std::size_t row) {
+                return limbs[xorwowLimbSlot(column) * XORWOW_CELL_LIMBS + j][row];
+            }
+
+            inline uint8_t limb(XorwowColumn column, unsigned j, std::size_t row) const {
+                return limbs[xorwowLimbSlot(column) * XORWOW_CELL_LIMBS + j][row];
+            }
+
+            /**
+            * @brief Refills the limb columns of a row from its cells.
+            *
+            * @param row The row to decompose.
+            */
+            void decompose(std::size_t row) {
+                for (std::size_t s = 0; s < XORWOW_NUM_LIMBED_COLUMNS; s++) {
+                    uint64_t cell = columns[XORWOW_LIMBED_COLUMNS[s]][row];
+                    for (unsigned j = 0; j < XORWOW_CELL_LIMBS; j++) {
+                        limbs[s * XORWOW_CELL_LIMBS + j][row] = static_cast<uint8_t>(cell >> (8 * j));
+                    }
+                }
+            }
+        };
+
+        /**
+        * @brief The public inputs of the xorwow circuit: the state the first row starts from and
+        *        the output of every row.
+        */
+        class XorwowInstance {
+        public:
+            std::array<uint64_t, 6> initialState = {};  ///< x[0..4] and the counter before the first step
+            std::vector<uint64_t> outputs;               ///< the claimed output of every step
+
+            XorwowInstance() = default;
+
+            /**
+            * @brief Builds the instance claiming that a seed produces the given outputs.
+            *
+            * @param seed The generator seed, public.
+            * @param outputs The claimed outputs, one per step.
+            */
+            XorwowInstance(uint64_t seed, std::vector<uint64_t> outputs);
+        };
+
+        /// the rows a gate is enabled on
+        enum XorwowGateRows {
+            XORWOW_ROWS_ALL,            ///< every row
+            XORWOW_ROWS_FIRST,          ///< the first row only
+            XORWOW_ROWS_ALL_BUT_LAST    ///< every row but the last, for gates querying the next row
+        };
+
+        /**
+        * @brief A custom gate. The constraint holds when eval returns zero on every row it is
+        *        enabled on.
+        */
+        struct XorwowGate {
+            const char *name;       ///< name reported when the gate fails
+            XorwowGateRows rows;    ///< the rows the gate is enabled on
+            XorwowGateValue (*eval)(const XorwowTrace &trace, const XorwowInstance &instance, std::size_t row);
+        };
+
+        /**
+        * @brief A lookup of the limb columns of (lhs, rhs, out) into the XOR table. With the
+        *        recomposition gates, proves out == lhs ^ rhs and that all three cells are 64-bit values.
+        */
+        struct XorwowXorLookup {
+            const char *name;
+            XorwowColumn lhs;
+            XorwowColumn rhs;
+            XorwowColumn out;
+        };
+
+        /**
+        * @brief A lookup proving that a cell fits in bits bits. 64-bit cells look up each of their
+        *        limb columns l as (l, 0, l) in the XOR table. Cells v of less than 8 bits look up
+        *        both v and v * 2^(8 - bits): the first bounds v below 2^8, so that the second
+        *        cannot wrap around the modulus and bounds it below 2^bits.
+        */
+        struct XorwowRangeLookup {
+            const char *name;
+            XorwowColumn column;
+            unsigned bits;
+        };
+
+        /**
+        * @brief Halo2-style description of one xorwow step over the Pallas scalar field.
+        *
+        * The shifts are linear decompositions whose shifted-out bits are range checked, the XORs
+        * are limb-wise lookups into a single 2^16 row table of (a, b, a ^ b) over 8-bit limbs and
+        * the 64-bit additions carry a boolean overflow bit. Consecutive rows are tied together by
+        * the state transition gates, the first row is pinned to the public initial state and the
+        * output of every row to its public output.
+        */
+        class XorwowCircuit {
+        public:
+            static constexpr unsigned LIMB_BITS = 8;                          ///< bits per lookup limb
+            static constexpr unsigned NUM_LIMBS = 64 / LIMB_BITS;             ///< limbs per 64-bit cell
+            static constexpr std::size_t XOR_TABLE_ROWS = std::size_t(1) << (2 * LIMB_BITS);
+            static constexpr uint64_t COUNTER_INCREMENT = XOR_ADD_VALUE;
+
+            /**
+            * @brief Returns the modulus of the Pallas scalar field.
+            */
+            static const XorwowGateValue &modulus();
+
+            /**
+            * @brief Returns the name of an advice column.
+            */
+            static const char *columnName(XorwowColumn column);
+
+            /**
+            * @brief Returns the custom gates of the circuit.
+            */
+            static const std::vector<XorwowGate> &gates();
+
+            /**
+            * @brief Returns the XOR lookups of the circuit.
+            */
+            static const std::vector<XorwowXorLookup> &xorLookups();
+
+            /**
+            * @brief Returns the range lookups of the circuit.
+            */
+            static const std::vector<XorwowRangeLookup> &rangeLookups();
+
+            /**
+            * @brief Fills the three fixed columns of the XOR table, row (a << 8 | b) holds (a, b, a ^ b).
+            *
+            * @param a The first input column.
+            * @param b The second input column.
+            * @param c The output column.
+            */
+            static void xorTable(std::vector<uint8_t> &a, std::vector<uint8_t> &b, std::vector<uint8_t> &c);
+
+            /**
+            * @brief Checks every gate and lookup of the circuit against a witness, the way a mock
+            *        prover would: gates are evaluated mod the field modulus and range checks only
+            *        rely on table lookups.
+            *
+            * @param trace The witness to check.
+            * @param instance The public inputs the witness is checked against.
+            * @param failure If not NULL, receives "<constraint name> at row <n>" of the first failure.
+            *
+            * @return true if the witness satisfies the circuit.
+            */
+            static bool verify(const XorwowTrace &trace, const XorwowInstance &instance, std::string *failure = NULL);
+        };
+
+    } // namespace circuit
+}  // namespace halo2
+
+#endif  // HALO2_XORWOW_CIRCUIT_H
@@ -0,0 +1,232 @@
+#include "../pch.h"
+
+using namespace std;
+
+namespace halo2 {
+    namespace circuit {
+
+        namespace {
+            constexpr unsigned STATE_WORDS = 5;
+            constexpr unsigned STATE_BITS = 64 * STATE_WORDS;
+
+            typedef array<uint64_t, STATE_WORDS> Gf2Vector;
+
+            // one step of the xorwow shift register, without the counter
+            inline void step(Gf2Vector &x) {
+                uint64_t t = x[4];
+                const uint64_t s = x[0];
+                x[4] = x[3];
+                x[3] = x[2];
+                x[2] = x[1];
+                x[1] = s;
+                t ^= (t >> 2);
+                t ^= (t << 1);
+                t ^= (s ^ (s << 4));
+                x[0] = t;
+            }
+
+            // 320x320 matrix over GF(2), stored as its columns
+            class Gf2Matrix {
+            public:
+                vector<Gf2Vector> cols;
+
+                Gf2Matrix() : cols(STATE_BITS, Gf2Vector{}) {}
+
+                static Gf2Matrix identity() {
+                    Gf2Matrix m;
+                    for (unsigned k = 0; k < STATE_BITS; k++) {
+                        m.cols[k][k / 64] = uint64_t(1) << (k % 64);
+                    }
+                    return m;
+                }
+
+                // the matrix of one step: column k is the image of the k-th unit vector
+                static Gf2Matrix stepMatrix() {
+                    Gf2Matrix m = identity();
+                    for (auto &col : m.cols) {
+                        step(col);
+                    }
+                    return m;
+                }
+
+                Gf2Vector apply(const Gf2Vector &v) const {
+                    Gf2Vector out{};
+                    for (unsigned k = 0; k < STATE_BITS; k++) {
+                        if ((v[k / 64] >> (k % 64)) & 1) {
+                            for (unsigned w = 0; w < STATE_WORDS; w++) {
+                                out[w] ^= cols[k][w];
+                            }
+                        }
+                    }
+                    return out;
+                }
+
+                Gf2Matrix operator*(const Gf2Matrix &other) const {
+                    Gf2Matrix out;
+                    for (unsigned k = 0; k < STATE_BITS; k++) {
+                        out.cols[k] = apply(other.cols[k]);
+                    }
+                    return out;
+                }
+
+                Gf2Matrix pow(uint64_t e) const {
+                    Gf2Matrix result = identity();
+                    Gf2Matrix base = *this;
+                    while (e > 0) {
+                        if (e & 1) {
+                            result = result * base;
+                        }
+                        e >>= 1;
+                        if (e > 0) {
+                            base = base * base;
+                        }
+                    }
+                    return result;
+                }
+            };
+
+            Gf2Vector toVector(const XORWOW_STATE &state) {
+                Gf2Vector v;
+                copy(begin(state.x), end(state.x), v.begin());
+                return v;
+            }
+
+            XORWOW_STATE toState(const Gf2Vector &v, uint64_t counter) {
+                XORWOW_STATE state;
+                copy(v.begin(), v.end(), begin(state.x));
+                state.counter = counter;
+                return state;
+            }
+
+            // fills rows [first, last) starting from x, which is the state at row first
+            void fillRows(XorwowTrace &trace, size_t first, size_t last, Gf2Vector x) {
+                const uint64_t inc = XorwowCircuit::COUNTER_INCREMENT;
+                auto col = [&](XorwowColumn c) { return trace.columns[c].data(); };
+
+                uint64_t *__restrict x0 = col(XORWOW_COL_X0);
+                uint64_t *__restrict x1 = col(XORWOW_COL_X1);
+                uint64_t *__restrict x2 = col(XORWOW_COL_X2);
+                uint64_t *__restrict x3 = col(XORWOW_COL_X3);
+                uint64_t *__restrict x4 = col(XORWOW_COL_X4);
+                uint64_t *__restrict counter = col(XORWOW_COL_COUNTER);
+                uint64_t *__restrict tShr2 = col(XORWOW_COL_T_SHR2);
+                uint64_t *__restrict tShr2Rem = col(XORWOW_COL_T_SHR2_REM);
+                uint64_t *__restrict t1 = col(XORWOW_COL_T1);
+                uint64_t *__restrict t1Shl1 = col(XORWOW_COL_T1_SHL1);
+                uint64_t *__restrict t1Shl1Hi = col(XORWOW_COL_T1_SHL1_HI);
+                uint64_t *__restrict t2 = col(XORWOW_COL_T2);
+                uint64_t *__restrict sShl4 = col(XORWOW_COL_S_SHL4);
+                uint64_t *__restrict sShl4Hi = col(XORWOW_COL_S_SHL4_HI);
+                uint64_t *__restrict u = col(XORWOW_COL_U);
+                uint64_t *__restrict t3 = col(XORWOW_COL_T3);
+                uint64_t *__restrict counterNext = col(XORWOW_COL_COUNTER_NEXT);
+                uint64_t *__restrict counterCarry = col(XORWOW_COL_COUNTER_CARRY);
+                uint64_t *__restrict out = col(XORWOW_COL_OUT);
+                uint64_t *__restrict outCarry = col(XORWOW_COL_OUT_CARRY);
+
+                for (size_t blockBegin = first; blockBegin < last; blockBegin += XorwowWitnessGenerator::BLOCK_ROWS) {
+                    size_t blockEnd = min(last, blockBegin + XorwowWitnessGenerator::BLOCK_ROWS);
+
+                    // the state recurrence is the only sequential part
+                    for (size_t r = blockBegin; r < blockEnd; r++) {
+                        x0[r] = x[0];
+                        x1[r] = x[1];
+                        x2[r] = x[2];
+                        x3[r] = x[3];
+                        x4[r] = x[4];
+                        step(x);
+                    }
+
+                    // every other column only depends on its own row
+                    for (size_t r = blockBegin; r < blockEnd; r++) {
+                        const uint64_t s = x0[r];
+                        const uint64_t t = x4[r];
+                        const uint64_t a = t ^ (t >> 2);
+                        const uint64_t b = a ^ (a << 1);
+                        const uint64_t c = s ^ (s << 4);
+                        const uint64_t d = b ^ c;
+                        const uint64_t cnt = uint64_t(r) * inc;
+                        const uint64_t next = cnt + inc;
+                        const uint64_t o = d + next;
+                        tShr2[r] = t >> 2;
+                        tShr2Rem[r] = t & 3;
+                        t1[r] = a;
+                        t1Shl1[r] = a << 1;
+                        t1Shl1Hi[r] = a >> 63;
+                        t2[r] = b;
+                        sShl4[r] = s << 4;
+                        sShl4Hi[r] = s >> 60;
+                        u[r] = c;
+                        t3[r] = d;
+                        counter[r] = cnt;
+                        counterNext[r] = next;
+                        counterCarry[r] = next < cnt;
+                        out[r] = o;
+                        outCarry[r] = o < d;
+                    }
+
+                    // one byte of one cell per pass keeps the limb loops vectorizable
+                    for (size_t s = 0; s < XORWOW_NUM_LIMBED_COLUMNS; s++) {
+                        const uint64_t *__restrict cell = col(XORWOW_LIMBED_COLUMNS[s]);
+                        for (unsigned j = 0; j < XORWOW_CELL_LIMBS; j++) {
+                            uint8_t *__restrict limb = trace.limbs[s * XORWOW_CELL_LIMBS + j].data();
+                            for (size_t r = blockBegin; r < blockEnd; r++) {
+                                limb[r] = static_cast<uint8_t>(cell[r] >> (8 * j));
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        XORWOW_STATE XorwowWitnessGenerator::initialState(uint64_t seed) {
+            XORWOW_STATE state;
+            state.x[0] = seed & UINT32_MAX;
+            state.x[1] = seed >> 32;
+            state.x[2] = state.x[0] ^ 0xdeadbeef;
+            state.x[3] = state.x[1] ^ 0xdeadbeef;
+            state.x[4] = 0xdeadc0de;
+            state.counter = 0;
+            return state;
+        }
+
+        XORWOW_STATE XorwowWitnessGenerator::jump(const XORWOW_STATE &state, uint64_t steps) {
+            Gf2Vector v = Gf2Matrix::stepMatrix().pow(steps).apply(toVector(state));
+            return toState(v, state.counter + steps * XorwowCircuit::COUNTER_INCREMENT);
+        }
+
+        void XorwowWitnessGenerator::generate(uint64_t seed, size_t steps, XorwowTrace &trace, unsigned threads) {
+            trace.resize(steps);
+            if (steps == 0) {
+                return;
+            }
+
+            if (threads == 0) {
+                threads = max(1u, thread::hardware_concurrency());
+            }
+            if (steps < MIN_PARALLEL_STEPS) {
+                threads = 1;
+            }
+
+            const size_t chunk = (steps + threads - 1) / threads;
+            const Gf2Matrix chunkJump = threads > 1 ? Gf2Matrix::stepMatrix().pow(chunk) : Gf2Matrix::identity();
+
+            vector<thread> workers;
+            Gf2Vector start = toVector(initialState(seed));
+            for (size_t first = 0; first < steps; first += chunk) {
+                size_t last = min(steps, first + chunk);
+                if (last == steps) {
+                    // the last chunk runs on the calling thread
+                    fillRows(trace, first, last, start);
+                } else {
+                    workers.emplace_back(fillRows, ref(trace), first, last, start);
+                    start = chunkJump.apply(start);
+                }
+            }
+            for (auto &worker : workers) {
+                worker.join();
+            }
+        }
+
+    } // namespace circuit
+}  // namespace halo2
@@ -0,0 +1,56 @@
+#ifndef HALO2_XORWOW_WITNESS_H
+#define HALO2_XORWOW_WITNESS_H
+
+namespace halo2 {
+    namespace circuit {
+
+        /**
+        * @brief Fills the xorwow circuit trace for many steps from a seed.
+        *
+        * The shift/XOR network of xorwow is linear over GF(2) on the 320 bits of x[0..4], and the
+        * counter after i steps is i * XOR_ADD_VALUE, so the state at any step is reachable with a
+        * 320x320 bit matrix power. The rows are split into one chunk per thread, each thread jumps
+        * to the start of its chunk and fills it block by block: first the sequential state
+        * recurrence, then the row-independent intermediate columns in a loop the compiler can
+        * vectorize.
+        */
+        class XorwowWitnessGenerator {
+        public:
+            /// rows filled by a thread between the recurrence pass and the intermediate columns pass
+            static constexpr std::size_t BLOCK_ROWS = 4096;
+
+            /// below this number of steps a single thread fills the whole trace
+            static constexpr std::size_t MIN_PARALLEL_STEPS = 1 << 16;
+
+            /**
+            * @brief Returns the state the unencrypted xorwow generator starts from.
+            *
+            * @param seed The generator seed.
+            */
+            static XORWOW_STATE initialState(uint64_t seed);
+
+            /**
+            * @brief Advances a state by a number of steps without running them one by one.
+            *
+            * @param state The state to advance.
+            * @param steps The number of steps to advance by.
+            *
+            * @return The state after the given number of steps.
+            */
+            static XORWOW_STATE jump(const XORWOW_STATE &state, uint64_t steps);
+
+            /**
+            * @brief Generates the witness of the xorwow circuit for a number of steps.
+            *
+            * @param seed The generator seed.
+            * @param steps The number of steps, one trace row per step.
+            * @param trace The trace to fill, resized to steps rows.
+            * @param threads The number of threads to use, 0 for the hardware concurrency.
+            */
+            static void generate(uint64_t seed, std::size_t steps, XorwowTrace &trace, unsigned threads = 0);
+        };
+
+    } // namespace circuit
+}  // namespace halo2
+
+#endif  // HALO2_XORWOW_WITNESS_H
@@ -10,9 +10,9 @@ namespace halo2 {
             uint64_t res = 1;
             while (b > 0) {
                 if (b & 1) {
-                    res = (res * a) % p;
+                    res = mulmod(res, a, p);
                 }
-                a = (a * a) % p;
+                a = mulmod(a, a, p);
                 b >>= 1;
             }
             return res;
@@ -25,6 +25,9 @@ namespace halo2 {
             uint64_t y = 1;
             uint64_t t;
             while (a > 1) {
+                if (b == 0) {
+                    throw domain_error("PaillierCryptoSystem::inv: gcd(a, p) > 1, there is no inverse");
+                }
                 uint64_t q = a / b;
                 t = b;
                 b = a % b;
@@ -33,34 +36,46 @@ namespace halo2 {
                 x = y - q * x;
                 y = t;
             }
+            if (a == 0) {
+                throw domain_error("PaillierCryptoSystem::inv: a = 0 mod p, there is no inverse");
+            }
             return (y + p) % p;
         }
 
+        // Draw r until it is a unit mod n, otherwise the ciphertext cannot be decrypted
+        uint64_t PaillierCryptoSystem::randomUnit(uint64_t n) {
+            uint64_t r;
+            do {
+                r = rand() % n;
+            } while (gcd(r, n) != 1);
+            return r;
+        }
+
         // Encrypt a plaintext message using the Paillier public key
         Ciphertext PaillierCryptoSystem::encrypt(PublicKey &pk, uint64_t m) {
-            uint64_t r = rand() % pk.n;
+            uint64_t r = randomUnit(pk.n);
             Ciphertext ct;
             ct.x = fpow(pk.g, m, pk.n2);
             ct.y = fpow(r, pk.n, pk.n2);
-            ct.x = (ct.x * ct.y) % pk.n2;
+            ct.x = mulmod(ct.x, ct.y, pk.n2);
             return ct;
         }
 
 
         // Encrypt a plaintext message using the Paillier public key
         void PaillierCryptoSystem::encrypt(PublicKey &pk, uint64_t m, Ciphertext &out) {
-            uint64_t r = rand() % pk.n;
+            uint64_t r = randomUnit(pk.n);
             out.x = fpow(pk.g, m, pk.n2);
             out.y = fpow(r, pk.n, pk.n2);
-            out.x = (out.x * out.y) % pk.n2;
+            out.x = mulmod(out.x, out.y, pk.n2);
         }
 
         // Encrypt a plaintext message using the Paillier public key
         void PaillierCryptoSystem::encrypt(PublicKey &pk, uint64_t m, uint64_t lambda, Ciphertext &out) {
-            uint64_t r = rand() % pk.n;
+            uint64_t r = randomUnit(pk.n);
             out.x = fpow(pk.g, m, pk.n2);
             out.y = fpow(r, pk.n, pk.n2);
-            out.x = (out.x * out.y) % pk.n2;
+            out.x = mulmod(out.x, out.y, pk.n2);
             bootstrap(pk, lambda, out);
         }
 
@@ -68,7 +83,7 @@ namespace halo2 {
         uint64_t PaillierCryptoSystem::decrypt(PublicKey &pk, PrivateKey &sk, Ciphertext &ct) {
             uint64_t x_inv = fpow(ct.x, sk.lambda, pk.n2);
             uint64_t x_inv_inv = inv(x_inv, pk.n2);
-            uint64_t m = (x_inv_inv * ct.y) % pk.n2;
+            uint64_t m = mulmod(x_inv_inv, ct.y, pk.n2);
             m = fpow(m, sk.mu, pk.n2);
             m = (m - 1) / pk.n;
             return m;
@@ -78,17 +93,46 @@ namespace halo2 {
         void PaillierCryptoSystem::decrypt(PublicKey &pk, PrivateKey &sk, Ciphertext &ct, uint64_t &outValue) {
             uint64_t x_inv = fpow(ct.x, sk.lambda, pk.n2);
             uint64_t x_inv_inv = inv(x_inv, pk.n2);
-            uint64_t m = (x_inv_inv * ct.y) % pk.n2;
+            uint64_t m = mulmod(x_inv_inv, ct.y, pk.n2);
             m = fpow(m, sk.mu, pk.n2);
             outValue = (m - 1) / pk.n;
         }
 
+        // Encrypt a batch of plaintext messages, one stage at a time over the whole batch
+        void PaillierCryptoSystem::encrypt(PublicKey &pk, const uint64_t *m, size_t count, Ciphertext *out) {
+            memory::ArenaScope scope;
+            uint64_t *r = scope.arena().allocateLimbs(count);
+            for (size_t i = 0; i < count; i++) {
+                r[i] = randomUnit(pk.n);
+            }
+            for (size_t i = 0; i < count; i++) {
+                out[i].y = fpow(r[i], pk.n, pk.n2);
+            }
+            for (size_t i = 0; i < count; i++) {
+                out[i].x = mulmod(fpow(pk.g, m[i], pk.n2), out[i].y, pk.n2);
+            }
+        }
+
+        // Decrypt a batch of Paillier ciphertexts, one stage at a time over the whole batch
+        void PaillierCryptoSystem::decrypt(PublicKey &pk, PrivateKey &sk, const Ciphertext *ct, size_t count,
+                                           uint64_t *outValues) {
+            memory::ArenaScope scope;
+            uint64_t *xInvInv = scope.arena().allocateLimbs(count);
+            for (size_t i = 0; i < count; i++) {
+                xInvInv[i] = inv(fpow(ct[i].x, sk.lambda, pk.n2), pk.n2);
+            }
+            for (size_t i = 0; i < count; i++) {
+                uint64_t m = mulmod(xInvInv[i], ct[i].y, pk.n2);
+                outValues[i] = (fpow(m, sk.mu, pk.n2) - 1) / pk.n;
+            }
+        }
+
         // Perform bootstrapping on a Paillier ciphertext
         void PaillierCryptoSystem::bootstrap(PublicKey &pk, uint64_t lambda, Ciphertext &ct) {
             uint64_t x_inv = fpow(ct.x, lambda, pk.n2);
             uint64_t x_inv_inv = inv(x_inv, pk.n2);
-            ct.x = (x_inv_inv * ct.x) % pk.n2;
-            ct.y = (x_inv_inv * ct.y) % pk.n2;
+            ct.x = mulmod(x_inv_inv, ct.x, pk.n2);
+            ct.y = mulmod(x_inv_inv, ct.y, pk.n2);
         }
 
         /**
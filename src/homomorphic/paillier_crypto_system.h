@@ -31,10 +31,21 @@ namespace halo2 {
             * @param a The number whose modular inverse is to be computed.
             * @param p The modulus.
             *
-            * @return The modular inverse of a mod p, if it exists.
+            * @return The modular inverse of a mod p.
+            *
+            * @throws std::domain_error if a has no inverse mod p.
             */
             static uint64_t inv(uint64_t a, uint64_t p);
 
+            /**
+            * @brief Draws the random r of an encryption, redrawing until it is a unit mod n.
+            *
+            * @param n The modulus of the public key.
+            *
+            * @return A random r in [1, n) with gcd(r, n) = 1.
+            */
+            static uint64_t randomUnit(uint64_t n);
+
             /**
             * @brief Encrypts a plaintext message using the Paillier public key.
             *
@@ -88,6 +99,29 @@ namespace halo2 {
             */
             static void decrypt(PublicKey &pk, PrivateKey &sk, Ciphertext &ct, uint64_t &outValue);
 
+            /**
+            * @brief Encrypts a batch of plaintext messages using the Paillier public key. The working
+            *        buffers of the batch come from the calling thread's arena and are released on return.
+            *
+            * @param pk The Paillier public key to use for encryption.
+            * @param m  The plaintext messages to encrypt.
+            * @param count The number of messages.
+            * @param out The array of count ciphertexts to fill in, e.g. a memory::CiphertextBatch.
+            */
+            static void encrypt(PublicKey &pk, const uint64_t *m, size_t count, Ciphertext *out);
+
+            /**
+            * @brief Decrypts a batch of Paillier ciphertexts using the Paillier keys. The working
+            *        buffers of the batch come from the calling thread's arena and are released on return.
+            *
+            * @param pk The Paillier public key to use for decryption.
+            * @param sk The Paillier private key to use for decryption.
+            * @param ct The Paillier ciphertexts to decrypt.
+            * @param count The number of ciphertexts.
+            * @param outValues The array of count plaintext messages to fill in.
+            */
+            static void decrypt(PublicKey &pk, PrivateKey &sk, const Ciphertext *ct, size_t count, uint64_t *outValues);
+
             /**
             * @brief Performs bootstrapping on a Paillier ciphertext.
             *
@@ -111,6 +145,11 @@ namespace halo2 {
                 return a % b;
             }
 
+            /// a * b mod p without overflow, for any p up to 2^64
+            static inline uint64_t mulmod(uint64_t a, uint64_t b, uint64_t p) {
+                return static_cast<uint64_t>(static_cast<unsigned __int128>(a) * b % p);
+            }
+
             static inline uint64_t gcd(uint64_t a, uint64_t b) {
                 return b == 0 ? a : gcd(b, modulo(a, b));
             }
@@ -0,0 +1,39 @@
+#ifndef HALO2_THRESHOLD_KEY_H
+#define HALO2_THRESHOLD_KEY_H
+
+namespace halo2 {
+    namespace crypto {
+
+        /**
+        * @brief The public part of a threshold Paillier key. Any threshold of the parties key shares
+        *        decrypt together, fewer learn nothing.
+        */
+        class ThresholdPublicKey {
+        public:
+            uint64_t n;             ///< the n component of the public key, g is n + 1
+            uint64_t n2;            ///< pre-calculated n*n
+            uint32_t threshold;     ///< number of shares needed to decrypt
+            uint32_t parties;       ///< number of shares handed out
+            uint64_t delta;         ///< parties!, clears the denominators of the Lagrange coefficients
+            ThresholdPublicKey(uint64_t n = 0, uint32_t threshold = 0, uint32_t parties = 0, uint64_t delta = 0)
+                : n(n), n2(n * n), threshold(threshold), parties(parties), delta(delta) {}
+
+            /// returns the key to encrypt with PaillierCryptoSystem::encrypt, which is exact for any n*n below 2^64
+            inline PublicKey publicKey() const {
+                return PublicKey(n, n + 1);
+            }
+        };
+
+        /**
+        * @brief A share of the threshold Paillier private key, held by a single decryption node.
+        */
+        class KeyShare {
+        public:
+            uint32_t index;     ///< the point the share polynomial is evaluated at, 1 to parties
+            uint64_t share;     ///< the value of the share polynomial at index
+            KeyShare(uint32_t index = 0, uint64_t share = 0) : index(index), share(share) {}
+        };
+    }
+}
+
+#endif //HALO2_THRESHOLD_KEY_H
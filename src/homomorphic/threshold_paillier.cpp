@@ -0,0 +1,470 @@
+#include "../pch.h"
+
+using namespace std;
+
+namespace halo2 {
+    namespace crypto {
+
+        namespace {
+            BignumPtr bignum(uint64_t value) {
+                BignumPtr bn(BN_new(), BN_free);
+                BN_set_word(bn.get(), value);
+                return bn;
+            }
+
+            std::unique_ptr<BN_MONT_CTX, void (*)(BN_MONT_CTX *)> montgomery(const BIGNUM *modulus) {
+                memory::BignumScope bignums;
+                std::unique_ptr<BN_MONT_CTX, void (*)(BN_MONT_CTX *)> mont(BN_MONT_CTX_new(), BN_MONT_CTX_free);
+                BN_MONT_CTX_set(mont.get(), modulus, bignums.ctx());
+                return mont;
+            }
+
+            inline bool contains(const vector<uint32_t> &indices, uint32_t index) {
+                return find(indices.begin(), indices.end(), index) != indices.end();
+            }
+        }
+
+        bool ThresholdDealer::generateKeys(uint32_t threshold, uint32_t parties, int primeBits,
+                                           ThresholdPublicKey &pk, vector<KeyShare> &shares) {
+            if (primeBits < MIN_PRIME_BITS || primeBits > MAX_PRIME_BITS) {
+                return false;
+            }
+
+            memory::BignumScope bignums;
+            BIGNUM *p = bignums.get();
+            BIGNUM *q = bignums.get();
+            do {
+                if (!BN_generate_prime_ex(p, primeBits, 1, NULL, NULL, NULL) ||
+                    !BN_generate_prime_ex(q, primeBits, 1, NULL, NULL, NULL)) {
+                    return false;
+                }
+            } while (BN_cmp(p, q) == 0 || BN_get_word(p) <= parties || BN_get_word(q) <= parties);
+
+            return splitKey(BN_get_word(p), BN_get_word(q), threshold, parties, pk, shares);
+        }
+
+        bool ThresholdDealer::splitKey(uint64_t p, uint64_t q, uint32_t threshold, uint32_t parties,
+                                       ThresholdPublicKey &pk, vector<KeyShare> &shares) {
+            if (threshold == 0 || threshold > parties || parties > MAX_PARTIES) {
+                return false;
+            }
+            // 4 * delta^2 has to be invertible mod n, and n*n has to fit in 64 bits
+            const uint64_t limit = uint64_t(1) << 32;
+            if (p == q || p <= parties || q <= parties || (p & 1) == 0 || (q & 1) == 0 ||
+                p >= limit || q >= limit || p * q >= limit) {
+                return false;
+            }
+
+            uint64_t n = p * q;
+            uint64_t m = ((p - 1) / 2) * ((q - 1) / 2);
+            uint64_t delta = 1;
+            for (uint32_t i = 2; i <= parties; i++) {
+                delta *= i;
+            }
+
+            memory::BignumScope bignums;
+            BIGNUM *bnN = bignums.get();
+            BIGNUM *bnM = bignums.get();
+            BIGNUM *nm = bignums.get();
+            BIGNUM *d = bignums.get();
+            BIGNUM *x = bignums.get();
+            BIGNUM *y = bignums.get();
+            BN_set_word(bnN, n);
+            BN_set_word(bnM, m);
+            BN_mul(nm, bnN, bnM, bignums.ctx());
+
+            // d = 0 mod m and d = 1 mod n
+            if (!BN_mod_inverse(d, bnM, bnN, bignums.ctx())) {
+                ERR_clear_error();
+                return false;
+            }
+            BN_mul(d, d, bnM, bignums.ctx());
+
+            // f(X) = d + a_1 X + ... + a_(t-1) X^(t-1) over Z_nm
+            vector<BIGNUM *> coefficients(threshold);
+            coefficients[0] = d;
+            for (uint32_t k = 1; k < threshold; k++) {
+                coefficients[k] = bignums.get();
+                BN_rand_range(coefficients[k], nm);
+            }
+
+            shares.clear();
+            for (uint32_t i = 1; i <= parties; i++) {
+                BN_zero(y);
+                BN_set_word(x, i);
+                for (uint32_t k = threshold; k-- > 0;) {
+                    BN_mod_mul(y, y, x, nm, bignums.ctx());
+                    BN_mod_add(y, y, coefficients[k], nm, bignums.ctx());
+                }
+                shares.emplace_back(i, BN_get_word(y));
+            }
+
+            pk = ThresholdPublicKey(n, threshold, parties, delta);
+            return true;
+        }
+
+        ThresholdDecryptionNode::ThresholdDecryptionNode(const ThresholdPublicKey &pk, const KeyShare &share)
+            : _pk(pk), _share(share), _n2(bignum(pk.n2)), _exponent(bignum(share.share)),
+              _mont(montgomery(_n2.get())) {
+            BN_mul_word(_exponent.get(), pk.delta);
+            BN_lshift1(_exponent.get(), _exponent.get());
+        }
+
+        const BIGNUM *ThresholdDecryptionNode::exponent(const vector<uint32_t> &indices) const {
+            lock_guard<mutex> lock(_mutex);
+            auto it = _exponents.find(indices);
+            if (it == _exponents.end()) {
+                LagrangeCoefficients lagrange(_pk, indices);
+                size_t i = find(indices.begin(), indices.end(), _share.index) - indices.begin();
+                memory::BignumScope bignums;
+                BignumPtr exponent(BN_new(), BN_free);
+                BN_mul(exponent.get(), _exponent.get(), lagrange.exponents[i].get(), bignums.ctx());
+                it = _exponents.emplace(indices, move(exponent)).first;
+            }
+            return it->second.get();
+        }
+
+        bool ThresholdDecryptionNode::partialDecrypt(const vector<uint32_t> &indices, const uint64_t *ciphertexts,
+                                                     size_t count, uint64_t *outPartials) const {
+            if (!LagrangeCoefficients::isValidSet(_pk, indices) ||
+                find(indices.begin(), indices.end(), _share.index) == indices.end()) {
+                return false;
+            }
+            const BIGNUM *e = exponent(indices);
+
+            memory::BignumScope bignums;
+            BIGNUM *c = bignums.get();
+            BIGNUM *r = bignums.get();
+            if (!r) {
+                return false;
+            }
+            for (size_t i = 0; i < count; i++) {
+                BN_set_word(c, ciphertexts[i]);
+                BN_mod_exp_mont(r, c, e, _n2.get(), bignums.ctx(), _mont.get());
+                outPartials[i] = BN_get_word(r);
+            }
+            return true;
+        }
+
+        PartialDecryptionResponse ThresholdDecryptionNode::handle(const PartialDecryptionRequest &request) const {
+            PartialDecryptionResponse response;
+            response.batchId = request.batchId;
+            response.index = _share.index;
+            response.indices = request.indices;
+            response.partials.resize(request.ciphertexts.size());
+            if (!partialDecrypt(request.indices, request.ciphertexts.data(), request.ciphertexts.size(),
+                                response.partials.data())) {
+                // an empty answer, which the combiner rejects
+                response.partials.clear();
+            }
+            return response;
+        }
+
+        bool LagrangeCoefficients::isValidSet(const ThresholdPublicKey &pk, const vector<uint32_t> &indices) {
+            if (indices.size() != pk.threshold) {
+                return false;
+            }
+            for (size_t i = 0; i < indices.size(); i++) {
+                if (indices[i] < 1 || indices[i] > pk.parties || (i > 0 && indices[i] <= indices[i - 1])) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        LagrangeCoefficients::LagrangeCoefficients(const ThresholdPublicKey &pk, const vector<uint32_t> &indices)
+            : indices(indices) {
+            memory::BignumScope bignums;
+            BIGNUM *numerator = bignums.get();
+            BIGNUM *denominator = bignums.get();
+
+            for (uint32_t i : indices) {
+                // lambda_i = delta * prod(j) / prod(j - i), an exact division
+                BN_set_word(numerator, pk.delta);
+                int64_t product = 1;
+                for (uint32_t j : indices) {
+                    if (j != i) {
+                        BN_mul_word(numerator, j);
+                        product *= int64_t(j) - int64_t(i);
+                    }
+                }
+                BN_set_word(denominator, product < 0 ? uint64_t(-product) : uint64_t(product));
+
+                BignumPtr exponent(BN_new(), BN_free);
+                BN_div(exponent.get(), NULL, numerator, denominator, bignums.ctx());
+                BN_lshift1(exponent.get(), exponent.get());
+                exponents.push_back(move(exponent));
+                negative.push_back(product < 0);
+            }
+        }
+
+        ThresholdCombiner::ThresholdCombiner(const ThresholdPublicKey &pk, ThresholdTransport &transport,
+                                             size_t batchSize, chrono::milliseconds timeout)
+            : _pk(pk), _transport(transport), _batchSize(max<size_t>(1, batchSize)), _timeout(timeout),
+              _n2(bignum(pk.n2)) {
+            memory::BignumScope bignums;
+            BIGNUM *x = bignums.get();
+            BIGNUM *n = bignums.get();
+            BN_set_word(n, pk.n);
+            BN_set_word(x, pk.delta);
+            BN_mod_sqr(x, x, n, bignums.ctx());
+            BN_mod_lshift(x, x, 2, n, bignums.ctx());
+            if (!BN_mod_inverse(x, x, n, bignums.ctx())) {
+                ERR_clear_error();
+                throw invalid_argument("ThresholdCombiner: 4 * delta^2 is not invertible mod n");
+            }
+            _inv4Delta2 = BN_get_word(x);
+        }
+
+        const LagrangeCoefficients &ThresholdCombiner::coefficients(const vector<uint32_t> &indices) {
+            auto it = _coefficients.find(indices);
+            if (it == _coefficients.end()) {
+                it = _coefficients.emplace(indices, LagrangeCoefficients(_pk, indices)).first;
+            }
+            return it->second;
+        }
+
+        bool ThresholdCombiner::decrypt(const Ciphertext *ct, size_t count, uint64_t *outValues) {
+            typedef chrono::steady_clock Clock;
+
+            vector<uint32_t> reachable = _transport.nodes();
+            sort(reachable.begin(), reachable.end());
+            if (reachable.size() < _pk.threshold) {
+                return false;
+            }
+
+            const size_t batches = (count + _batchSize - 1) / _batchSize;
+            const uint64_t firstBatchId = _nextBatchId;
+            _nextBatchId += batches;
+
+            struct Batch {
+                vector<uint32_t> set;                           ///< the nodes the batch was sent to, increasing
+                vector<PartialDecryptionResponse> responses;    ///< the responses received so far
+                bool done = false;
+            };
+            vector<Batch> state(batches);
+            auto answered = [](const Batch &batch, uint32_t index) {
+                return any_of(batch.responses.begin(), batch.responses.end(),
+                              [&](const PartialDecryptionResponse &r) { return r.index == index; });
+            };
+
+            // a node is given the timeout to answer its oldest request of this call, the deadline is
+            // pushed back by every answer so that a node working through a backlog is not taken for
+            // a dead one
+            struct Node {
+                size_t inFlight = 0;
+                Clock::time_point deadline;
+            };
+            map<uint32_t, Node> progress;
+            vector<uint32_t> unresponsive;
+
+            PartialDecryptionRequest request;
+            // sends batch b to the first threshold nodes of its rotation that are not passed over,
+            // returns false if there are not enough of them left
+            auto dispatch = [&](size_t b) {
+                Batch &batch = state[b];
+                uint64_t batchId = firstBatchId + b;
+                // the rotation follows the batch id, so that successive calls keep spreading the load
+                vector<uint32_t> set;
+                for (size_t j = 0; j < reachable.size() && set.size() < _pk.threshold; j++) {
+                    uint32_t index = reachable[(batchId + j) % reachable.size()];
+                    if (!contains(unresponsive, index)) {
+                        set.push_back(index);
+                    }
+                }
+                if (set.size() < _pk.threshold) {
+                    return false;
+                }
+                sort(set.begin(), set.end());
+
+                // the nodes raise to their Lagrange coefficient in the set, a new set voids the
+                // partials received so far
+                batch.set = move(set);
+                batch.responses.clear();
+                size_t first = b * _batchSize;
+                size_t last = min(count, first + _batchSize);
+                request.batchId = batchId;
+                request.indices = batch.set;
+                request.ciphertexts.resize(last - first);
+                for (size_t i = first; i < last; i++) {
+                    request.ciphertexts[i - first] = ct[i].x;
+                }
+                Clock::time_point now = Clock::now();
+                for (uint32_t index : batch.set) {
+                    Node &node = progress[index];
+                    if (node.inFlight++ == 0) {
+                        node.deadline = now + _timeout;
+                    }
+                    _transport.send(index, request);
+                }
+                return true;
+            };
+
+            for (size_t b = 0; b < batches; b++) {
+                dispatch(b);
+            }
+
+            size_t remaining = batches;
+            PartialDecryptionResponse response;
+            while (remaining > 0) {
+                // a pending batch always has a node in its set that is still given time
+                Clock::time_point deadline = Clock::now() + _timeout;
+                for (const auto &entry : progress) {
+                    if (entry.second.inFlight > 0 && !contains(unresponsive, entry.first)) {
+                        deadline = min(deadline, entry.second.deadline);
+                    }
+                }
+                auto wait = chrono::ceil<chrono::milliseconds>(deadline - Clock::now());
+                ThresholdReceiveStatus status = _transport.receive(response, max(wait, chrono::milliseconds(0)));
+                if (status == THRESHOLD_CLOSED) {
+                    return false;
+                }
+
+                if (status == THRESHOLD_TIMED_OUT) {
+                    // the nodes past their deadline are passed over from now on, the batches waiting
+                    // on them go to other node sets
+                    Clock::time_point now = Clock::now();
+                    for (const auto &entry : progress) {
+                        if (entry.second.inFlight > 0 && entry.second.deadline <= now &&
+                            !contains(unresponsive, entry.first)) {
+                            unresponsive.push_back(entry.first);
+                        }
+                    }
+                    for (size_t b = 0; b < batches; b++) {
+                        const Batch &batch = state[b];
+                        if (batch.done) {
+                            continue;
+                        }
+                        bool waiting = any_of(batch.set.begin(), batch.set.end(), [&](uint32_t index) {
+                            return contains(unresponsive, index) && !answered(batch, index);
+                        });
+                        if (waiting && !dispatch(b)) {
+                            return false;
+                        }
+                    }
+                    continue;
+                }
+
+                // responses of an earlier, abandoned call
+                if (response.batchId < firstBatchId || response.batchId >= firstBatchId + batches) {
+                    continue;
+                }
+                auto node = progress.find(response.index);
+                if (node == progress.end()) {
+                    continue;
+                }
+                // any answer, even a stale one, shows the node is making progress: a slow node is
+                // not a dead one
+                if (node->second.inFlight > 0) {
+                    node->second.inFlight--;
+                }
+                node->second.deadline = Clock::now() + _timeout;
+                unresponsive.erase(remove(unresponsive.begin(), unresponsive.end(), response.index),
+                                   unresponsive.end());
+
+                size_t b = response.batchId - firstBatchId;
+                Batch &batch = state[b];
+                // late responses to a batch already combined, responses for a set the batch was moved
+                // off, and responses not asked for
+                if (batch.done || response.indices != batch.set || !contains(batch.set, response.index) ||
+                    answered(batch, response.index)) {
+                    continue;
+                }
+                batch.responses.push_back(move(response));
+                if (batch.responses.size() < _pk.threshold) {
+                    continue;
+                }
+
+                size_t first = b * _batchSize;
+                size_t size = min(count, first + _batchSize) - first;
+                vector<const PartialDecryptionResponse *> partials;
+                for (const auto &r : batch.responses) {
+                    partials.push_back(&r);
+                }
+                if (!combine(partials, size, outValues + first)) {
+                    return false;
+                }
+                batch.done = true;
+                batch.responses = vector<PartialDecryptionResponse>();
+                remaining--;
+            }
+            return true;
+        }
+
+        bool ThresholdCombiner::combine(const vector<const PartialDecryptionResponse *> &partials, size_t count,
+                                        uint64_t *outValues) {
+            if (partials.size() != _pk.threshold) {
+                return false;
+            }
+
+            vector<const PartialDecryptionResponse *> ordered(partials);
+            sort(ordered.begin(), ordered.end(),
+                 [](const PartialDecryptionResponse *a, const PartialDecryptionResponse *b) {
+                     return a->index < b->index;
+                 });
+            vector<uint32_t> indices;
+            for (const auto *partial : ordered) {
+                indices.push_back(partial->index);
+            }
+            if (!LagrangeCoefficients::isValidSet(_pk, indices)) {
+                return false;
+            }
+            for (const auto *partial : ordered) {
+                // every partial must be raised for this very set
+                if (partial->indices != indices || partial->partials.size() != count) {
+                    return false;
+                }
+            }
+            if (count == 0) {
+                return true;
+            }
+            const LagrangeCoefficients &lagrange = coefficients(indices);
+            const uint64_t n2 = _pk.n2;
+
+            memory::ArenaScope scope;
+            uint64_t *numerators = scope.arena().allocateLimbs(count);
+            uint64_t *denominators = scope.arena().allocateLimbs(count);
+            uint64_t *prefix = scope.arena().allocateLimbs(count);
+
+            // c' = prod(c_i^(4 delta s_i lambda_i)), the nodes did the exponentiations. The terms of
+            // a negative lambda_i are gathered in a denominator so that a single inversion per
+            // batch is needed
+            for (size_t k = 0; k < count; k++) {
+                uint64_t num = 1;
+                uint64_t den = 1;
+                for (size_t i = 0; i < ordered.size(); i++) {
+                    uint64_t &acc = lagrange.negative[i] ? den : num;
+                    acc = PaillierCryptoSystem::mulmod(acc, ordered[i]->partials[k], n2);
+                }
+                numerators[k] = num;
+                denominators[k] = den;
+                prefix[k] = k > 0 ? PaillierCryptoSystem::mulmod(prefix[k - 1], den, n2) : den;
+            }
+
+            memory::BignumScope bignums;
+            BIGNUM *inverse = bignums.get();
+            if (!inverse) {
+                return false;
+            }
+            BN_set_word(inverse, prefix[count - 1]);
+            if (!BN_mod_inverse(inverse, inverse, _n2.get(), bignums.ctx())) {
+                ERR_clear_error();
+                return false;
+            }
+            // running holds (den_0 * ... * den_k)^-1
+            uint64_t running = BN_get_word(inverse);
+
+            for (size_t k = count; k-- > 0;) {
+                uint64_t den = k > 0 ? PaillierCryptoSystem::mulmod(running, prefix[k - 1], n2) : running;
+                running = PaillierCryptoSystem::mulmod(running, denominators[k], n2);
+                uint64_t c = PaillierCryptoSystem::mulmod(numerators[k], den, n2);
+
+                // c' = (1 + n)^(4 delta^2 m), so L(c') = 4 delta^2 m mod n
+                uint64_t l = ((c - 1) / _pk.n) % _pk.n;
+                outValues[k] = PaillierCryptoSystem::mulmod(l, _inv4Delta2, _pk.n);
+            }
+            return true;
+        }
+
+    } // namespace crypto
+}  // namespace halo2
@@ -0,0 +1,215 @@
+#ifndef HALO2_THRESHOLD_PAILLIER_H
+#define HALO2_THRESHOLD_PAILLIER_H
+
+namespace halo2 {
+    namespace crypto {
+
+        /// an owned OpenSSL BIGNUM
+        typedef std::unique_ptr<BIGNUM, void (*)(BIGNUM *)> BignumPtr;
+
+        /**
+        * @brief The dealer of a threshold Paillier key.
+        *
+        * With n = pq for safe primes p = 2p' + 1, q = 2q' + 1 and m = p'q', the secret is the d
+        * with d = 0 mod m and d = 1 mod n. It is split with a random polynomial f of degree
+        * threshold - 1 over Z_nm with f(0) = d, and share i is f(i).
+        */
+        class ThresholdDealer {
+        public:
+            /// largest number of parties, so that parties! fits in 64 bits
+            static constexpr uint32_t MAX_PARTIES = 20;
+
+            /// smallest safe primes OpenSSL's prime sieve generates
+            static constexpr int MIN_PRIME_BITS = 12;
+
+            /// largest safe primes for which n*n fits in a Ciphertext component
+            static constexpr int MAX_PRIME_BITS = 16;
+
+            /**
+            * @brief Generates a fresh threshold key.
+            *
+            * @param threshold The number of shares needed to decrypt.
+            * @param parties The number of shares to hand out.
+            * @param primeBits The size of the safe primes, MIN_PRIME_BITS to MAX_PRIME_BITS.
+            * @param pk A reference to store the public key.
+            * @param shares A reference to store the key shares, one per party.
+            *
+            * @return false if the parameters are invalid.
+            */
+            static bool generateKeys(uint32_t threshold, uint32_t parties, int primeBits,
+                                     ThresholdPublicKey &pk, std::vector<KeyShare> &shares);
+
+            /**
+            * @brief Splits the key of known safe primes.
+            *
+            * @param p The first safe prime, larger than parties.
+            * @param q The second safe prime, larger than parties and different from p.
+            * @param threshold The number of shares needed to decrypt.
+            * @param parties The number of shares to hand out.
+            * @param pk A reference to store the public key.
+            * @param shares A reference to store the key shares, one per party.
+            *
+            * @return false if the parameters are invalid.
+            */
+            static bool splitKey(uint64_t p, uint64_t q, uint32_t threshold, uint32_t parties,
+                                 ThresholdPublicKey &pk, std::vector<KeyShare> &shares);
+        };
+
+        /**
+        * @brief A node holding one key share. For a set of threshold nodes, computes the partial
+        *        decryptions c^(4 * delta * share * lambda_i) mod n^2, lambda_i being the Lagrange
+        *        coefficient of the node in the set, so that the combiner only multiplies them.
+        *        The exponent of every set seen is computed once and cached.
+        */
+        class ThresholdDecryptionNode {
+        public:
+            ThresholdDecryptionNode(const ThresholdPublicKey &pk, const KeyShare &share);
+
+            ThresholdDecryptionNode(const ThresholdDecryptionNode &) = delete;
+            ThresholdDecryptionNode &operator=(const ThresholdDecryptionNode &) = delete;
+
+            inline uint32_t index() const {
+                return _share.index;
+            }
+
+            /**
+            * @brief Computes the partial decryptions of a batch of ciphertexts for a node set. The
+            *        sign of lambda_i is left to the combiner, the exponent is |4 * delta * share * lambda_i|.
+            *
+            * @param indices The node set, threshold increasing key share indices including this node's.
+            * @param ciphertexts The x components of the ciphertexts.
+            * @param count The number of ciphertexts.
+            * @param outPartials The array of count partial decryptions to fill in.
+            *
+            * @return false if indices is not a valid node set holding this node.
+            */
+            bool partialDecrypt(const std::vector<uint32_t> &indices, const uint64_t *ciphertexts, size_t count,
+                                uint64_t *outPartials) const;
+
+            /**
+            * @brief Answers a request received through a transport.
+            */
+            PartialDecryptionResponse handle(const PartialDecryptionRequest &request) const;
+
+        private:
+            /// returns the cached exponent of a valid node set
+            const BIGNUM *exponent(const std::vector<uint32_t> &indices) const;
+
+            ThresholdPublicKey _pk;
+            KeyShare _share;
+            BignumPtr _n2;
+            BignumPtr _exponent;    ///< 2 * delta * share, fixed for the node
+            std::unique_ptr<BN_MONT_CTX, void (*)(BN_MONT_CTX *)> _mont;
+            mutable std::mutex _mutex;
+            mutable std::map<std::vector<uint32_t>, BignumPtr> _exponents;  ///< |4 * delta * share * lambda_i| per set
+        };
+
+        /**
+        * @brief The exponents 2 * lambda_i, with lambda_i = delta * prod(j / (j - i)), that weigh
+        *        the partial decryptions of one set of shares. The nodes raise to them, the combiner
+        *        only needs their signs.
+        */
+        class LagrangeCoefficients {
+        public:
+            /**
+            * @brief Computes the coefficients of a set of shares.
+            *
+            * @param pk The threshold public key.
+            * @param indices The key share indices, exactly threshold distinct ones.
+            */
+            LagrangeCoefficients(const ThresholdPublicKey &pk, const std::vector<uint32_t> &indices);
+
+            /**
+            * @brief Checks that indices is a node set: threshold increasing indices in [1, parties].
+            */
+            static bool isValidSet(const ThresholdPublicKey &pk, const std::vector<uint32_t> &indices);
+
+            std::vector<uint32_t> indices;      ///< the key share indices, in the order of the exponents
+            std::vector<BignumPtr> exponents;   ///< |2 * lambda_i|
+            std::vector<bool> negative;         ///< the sign of lambda_i
+        };
+
+        /**
+        * @brief Splits decryptions into batches, has the reachable nodes compute partial
+        *        decryptions through a transport and merges them.
+        *
+        * Each batch goes to threshold nodes only. The set of nodes rotates over the reachable nodes
+        * with the batch id to spread the load, and the Lagrange coefficients of every set used
+        * are computed once and cached. A node with requests in flight must answer one of them
+        * within the timeout of the previous answer, or of the send if it had none pending, so the
+        * time spent queued behind other batches does not count against it. A node that misses its
+        * deadline is passed over until it answers again, and the batches waiting on it are sent to
+        * another set of nodes.
+        */
+        class ThresholdCombiner {
+        public:
+            static constexpr size_t DEFAULT_BATCH_SIZE = 256;
+            static constexpr int64_t DEFAULT_TIMEOUT_MS = 1000;
+
+            /**
+            * @brief Creates a combiner for a threshold key.
+            *
+            * @param pk The threshold public key.
+            * @param transport The link to the decryption nodes, it must outlive the combiner.
+            * @param batchSize The number of ciphertexts per request.
+            * @param timeout How long a node with requests in flight may go without answering
+            *        before its batches are sent to other nodes.
+            *
+            * @throws std::invalid_argument if 4 * delta^2 is not invertible mod n.
+            */
+            ThresholdCombiner(const ThresholdPublicKey &pk, ThresholdTransport &transport,
+                              size_t batchSize = DEFAULT_BATCH_SIZE,
+                              std::chrono::milliseconds timeout = std::chrono::milliseconds(DEFAULT_TIMEOUT_MS));
+
+            ThresholdCombiner(const ThresholdCombiner &) = delete;
+            ThresholdCombiner &operator=(const ThresholdCombiner &) = delete;
+
+            /**
+            * @brief Decrypts ciphertexts with the help of the decryption nodes.
+            *
+            * @param ct The ciphertexts to decrypt.
+            * @param count The number of ciphertexts.
+            * @param outValues The array of count plaintext messages to fill in.
+            *
+            * @return false if fewer than threshold nodes are reachable or answer in time, the
+            *         transport closed or a ciphertext is not invertible mod n^2.
+            */
+            bool decrypt(const Ciphertext *ct, size_t count, uint64_t *outValues);
+
+            /**
+            * @brief Merges the partial decryptions of one batch from exactly threshold nodes. Only
+            *        multiplications and a single inversion are left to the combiner.
+            *
+            * @param partials The responses of the nodes, all for the same batch and node set.
+            * @param count The number of ciphertexts in the batch.
+            * @param outValues The array of count plaintext messages to fill in.
+            *
+            * @return false unless there are exactly threshold responses with distinct indices in
+            *         [1, parties], each computed for the set of those indices with count partials,
+            *         or if a partial decryption is not invertible mod n^2.
+            */
+            bool combine(const std::vector<const PartialDecryptionResponse *> &partials, size_t count,
+                         uint64_t *outValues);
+
+            /// returns the number of node sets whose coefficients are cached
+            inline size_t cachedCoefficients() const {
+                return _coefficients.size();
+            }
+
+        private:
+            const LagrangeCoefficients &coefficients(const std::vector<uint32_t> &indices);
+
+            ThresholdPublicKey _pk;
+            ThresholdTransport &_transport;
+            size_t _batchSize;
+            std::chrono::milliseconds _timeout;
+            uint64_t _nextBatchId = 0;
+            uint64_t _inv4Delta2;    ///< (4 * delta^2)^-1 mod n
+            BignumPtr _n2;
+            std::map<std::vector<uint32_t>, LagrangeCoefficients> _coefficients;  ///< for the signs of lambda_i
+        };
+
+    } // namespace crypto
+}  // namespace halo2
+
+#endif  // HALO2_THRESHOLD_PAILLIER_H
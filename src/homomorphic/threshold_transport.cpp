@@ -0,0 +1,89 @@
+#include "../pch.h"
+
+using namespace std;
+
+namespace halo2 {
+    namespace crypto {
+
+        InProcessTransport::InProcessTransport(const vector<ThresholdDecryptionNode *> &nodes) {
+            for (ThresholdDecryptionNode *node : nodes) {
+                _workers.emplace_back(new Worker{node, {}, {}});
+            }
+            for (auto &worker : _workers) {
+                worker->thread = thread(&InProcessTransport::run, this, ref(*worker));
+            }
+        }
+
+        InProcessTransport::~InProcessTransport() {
+            close();
+        }
+
+        vector<uint32_t> InProcessTransport::nodes() const {
+            vector<uint32_t> indices;
+            for (const auto &worker : _workers) {
+                indices.push_back(worker->node->index());
+            }
+            return indices;
+        }
+
+        void InProcessTransport::send(uint32_t index, const PartialDecryptionRequest &request) {
+            lock_guard<mutex> lock(_mutex);
+            if (_closed) {
+                return;
+            }
+            for (auto &worker : _workers) {
+                if (worker->node->index() == index) {
+                    worker->requests.push_back(request);
+                    _requestReady.notify_all();
+                    return;
+                }
+            }
+        }
+
+        ThresholdReceiveStatus InProcessTransport::receive(PartialDecryptionResponse &response,
+                                                           chrono::milliseconds timeout) {
+            unique_lock<mutex> lock(_mutex);
+            _responseReady.wait_for(lock, timeout, [this]() { return _closed || !_responses.empty(); });
+            if (_responses.empty()) {
+                return _closed ? THRESHOLD_CLOSED : THRESHOLD_TIMED_OUT;
+            }
+            response = move(_responses.front());
+            _responses.pop_front();
+            return THRESHOLD_RECEIVED;
+        }
+
+        void InProcessTransport::close() {
+            {
+                lock_guard<mutex> lock(_mutex);
+                _closed = true;
+            }
+            _requestReady.notify_all();
+            _responseReady.notify_all();
+            for (auto &worker : _workers) {
+                if (worker->thread.joinable()) {
+                    worker->thread.join();
+                }
+            }
+        }
+
+        void InProcessTransport::run(Worker &worker) {
+            unique_lock<mutex> lock(_mutex);
+            while (true) {
+                _requestReady.wait(lock, [&]() { return _closed || !worker.requests.empty(); });
+                if (_closed) {
+                    return;
+                }
+                PartialDecryptionRequest request = move(worker.requests.front());
+                worker.requests.pop_front();
+
+                lock.unlock();
+                PartialDecryptionResponse response = worker.node->handle(request);
+                lock.lock();
+
+                _responses.push_back(move(response));
+                _responseReady.notify_all();
+            }
+        }
+
+    } // namespace crypto
+}  // namespace halo2
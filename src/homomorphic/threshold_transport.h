@@ -0,0 +1,114 @@
+#ifndef HALO2_THRESHOLD_TRANSPORT_H
+#define HALO2_THRESHOLD_TRANSPORT_H
+
+namespace halo2 {
+    namespace crypto {
+
+        class ThresholdDecryptionNode;
+
+        /**
+        * @brief A batch of ciphertexts sent by the combiner to a decryption node.
+        */
+        struct PartialDecryptionRequest {
+            uint64_t batchId;                   ///< chosen by the combiner, echoed in the response
+            std::vector<uint32_t> indices;      ///< the increasing key share indices of the nodes asked for the batch
+            std::vector<uint64_t> ciphertexts;  ///< the x components of the ciphertexts
+        };
+
+        /**
+        * @brief The partial decryptions of a batch computed by one decryption node.
+        */
+        struct PartialDecryptionResponse {
+            uint64_t batchId;                   ///< the batch the partials belong to
+            uint32_t index;                     ///< the index of the key share that computed them
+            std::vector<uint32_t> indices;      ///< the node set they were computed for
+            std::vector<uint64_t> partials;     ///< one partial decryption per ciphertext of the batch
+        };
+
+        /// outcome of ThresholdTransport::receive
+        enum ThresholdReceiveStatus {
+            THRESHOLD_RECEIVED,     ///< a response was stored
+            THRESHOLD_TIMED_OUT,    ///< no response arrived in time
+            THRESHOLD_CLOSED        ///< the transport is closed and no response will arrive
+        };
+
+        /**
+        * @brief The link between a combiner and the decryption nodes. Implementations may deliver
+        *        responses in any order and may drop requests to unreachable nodes.
+        */
+        class ThresholdTransport {
+        public:
+            virtual ~ThresholdTransport() = default;
+
+            /**
+            * @brief Returns the key share indices of the nodes currently reachable.
+            */
+            virtual std::vector<uint32_t> nodes() const = 0;
+
+            /**
+            * @brief Sends a request to the node holding the key share index.
+            *
+            * @param index The key share index of the node.
+            * @param request The request to send.
+            */
+            virtual void send(uint32_t index, const PartialDecryptionRequest &request) = 0;
+
+            /**
+            * @brief Waits for the next response from any node.
+            *
+            * @param response A reference to store the response.
+            * @param timeout The longest time to wait.
+            *
+            * @return THRESHOLD_RECEIVED if response was filled in.
+            */
+            virtual ThresholdReceiveStatus receive(PartialDecryptionResponse &response,
+                                                   std::chrono::milliseconds timeout) = 0;
+        };
+
+        /**
+        * @brief A transport to nodes running in the same process, each on its own thread.
+        */
+        class InProcessTransport : public ThresholdTransport {
+        public:
+            /**
+            * @brief Starts one worker thread per node.
+            *
+            * @param nodes The nodes to serve, they must outlive the transport.
+            */
+            explicit InProcessTransport(const std::vector<ThresholdDecryptionNode *> &nodes);
+
+            /// stops the worker threads, pending requests are dropped
+            ~InProcessTransport() override;
+
+            InProcessTransport(const InProcessTransport &) = delete;
+            InProcessTransport &operator=(const InProcessTransport &) = delete;
+
+            std::vector<uint32_t> nodes() const override;
+            void send(uint32_t index, const PartialDecryptionRequest &request) override;
+            ThresholdReceiveStatus receive(PartialDecryptionResponse &response,
+                                           std::chrono::milliseconds timeout) override;
+
+            /// stops the worker threads and wakes up receivers
+            void close();
+
+        private:
+            struct Worker {
+                ThresholdDecryptionNode *node;
+                std::deque<PartialDecryptionRequest> requests;
+                std::thread thread;
+            };
+
+            void run(Worker &worker);
+
+            std::mutex _mutex;
+            std::condition_variable _requestReady;
+            std::condition_variable _responseReady;
+            std::vector<std::unique_ptr<Worker>> _workers;
+            std::deque<PartialDecryptionResponse> _responses;
+            bool _closed = false;
+        };
+
+    } // namespace crypto
+}  // namespace halo2
+
+#endif  // HALO2_THRESHOLD_TRANSPORT_H
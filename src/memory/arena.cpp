@@ -0,0 +1,67 @@
+#include "../pch.h"
+
+using namespace std;
+
+namespace halo2 {
+    namespace memory {
+
+        void *Arena::allocate(size_t size, size_t alignment) {
+            while (_current < _chunks.size()) {
+                Chunk &chunk = _chunks[_current];
+                uintptr_t base = reinterpret_cast<uintptr_t>(chunk.data.get());
+                size_t aligned = ((base + _offset + alignment - 1) & ~(uintptr_t(alignment) - 1)) - base;
+                if (aligned + size <= chunk.size) {
+                    _offset = aligned + size;
+                    return chunk.data.get() + aligned;
+                }
+                // the rest of this chunk is unused until the next reset
+                _current++;
+                _offset = 0;
+            }
+
+            size_t chunkSize = max(_chunkSize, size + alignment);
+            _chunks.push_back(Chunk{unique_ptr<uint8_t[]>(new uint8_t[chunkSize]), chunkSize});
+            _current = _chunks.size() - 1;
+            _offset = 0;
+            return allocate(size, alignment);
+        }
+
+        size_t Arena::capacity() const {
+            size_t total = 0;
+            for (const auto &chunk : _chunks) {
+                total += chunk.size;
+            }
+            return total;
+        }
+
+        Arena &Arena::local() {
+            static thread_local Arena arena;
+            return arena;
+        }
+
+        namespace {
+            struct BignumPool {
+                BN_CTX *ctx = BN_CTX_new();
+
+                ~BignumPool() {
+                    BN_CTX_free(ctx);
+                }
+            };
+        }
+
+        BignumScope::BignumScope() {
+            static thread_local BignumPool pool;
+            _ctx = pool.ctx;
+            BN_CTX_start(_ctx);
+        }
+
+        BignumScope::~BignumScope() {
+            BN_CTX_end(_ctx);
+        }
+
+        BIGNUM *BignumScope::get() {
+            return BN_CTX_get(_ctx);
+        }
+
+    } // namespace memory
+}  // namespace halo2
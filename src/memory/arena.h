@@ -0,0 +1,151 @@
+#ifndef HALO2_ARENA_H
+#define HALO2_ARENA_H
+
+namespace halo2 {
+    namespace memory {
+
+        /**
+        * @brief A bump allocator for short-lived temporaries such as big-integer limb buffers.
+        *
+        * Memory is carved out of large chunks and is only given back all at once, by resetting the
+        * arena to a marker. Chunks are kept across resets, so once an arena has grown to the peak
+        * size of a workload, repeating that workload performs no heap allocation.
+        */
+        class Arena {
+        public:
+            static constexpr std::size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+            /// a position in the arena to reset back to
+            struct Marker {
+                std::size_t chunk;
+                std::size_t offset;
+            };
+
+            explicit Arena(std::size_t chunkSize = DEFAULT_CHUNK_SIZE) : _chunkSize(chunkSize) {}
+
+            Arena(const Arena &) = delete;
+            Arena &operator=(const Arena &) = delete;
+
+            /**
+            * @brief Allocates uninitialized memory that stays valid until the arena is reset past it.
+            *
+            * @param size The number of bytes.
+            * @param alignment The alignment of the returned pointer, a power of two.
+            *
+            * @return The allocated memory.
+            */
+            void *allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t));
+
+            /**
+            * @brief Allocates an array of default constructed, trivially destructible objects.
+            *
+            * @param count The number of objects.
+            */
+            template <typename T>
+            T *allocate(std::size_t count) {
+                static_assert(std::is_trivially_destructible<T>::value, "arena memory is never destroyed");
+                T *p = static_cast<T *>(allocate(count * sizeof(T), alignof(T)));
+                for (std::size_t i = 0; i < count; i++) {
+                    new (p + i) T();
+                }
+                return p;
+            }
+
+            /**
+            * @brief Allocates an uninitialized buffer of 64-bit limbs.
+            *
+            * @param count The number of limbs.
+            */
+            inline uint64_t *allocateLimbs(std::size_t count) {
+                return static_cast<uint64_t *>(allocate(count * sizeof(uint64_t), alignof(uint64_t)));
+            }
+
+            /// returns the current position of the arena
+            inline Marker mark() const {
+                return Marker{_current, _offset};
+            }
+
+            /**
+            * @brief Releases everything allocated after a marker. The chunks are kept for reuse.
+            *
+            * @param marker A marker returned by mark() since the last reset before it.
+            */
+            inline void reset(const Marker &marker) {
+                _current = marker.chunk;
+                _offset = marker.offset;
+            }
+
+            /// releases everything allocated from the arena
+            inline void reset() {
+                reset(Marker{0, 0});
+            }
+
+            /// returns the number of bytes held by the arena's chunks
+            std::size_t capacity() const;
+
+            /// returns the arena of the calling thread
+            static Arena &local();
+
+        private:
+            struct Chunk {
+                std::unique_ptr<uint8_t[]> data;
+                std::size_t size;
+            };
+
+            std::size_t _chunkSize;
+            std::vector<Chunk> _chunks;
+            std::size_t _current = 0;   ///< index of the chunk being allocated from
+            std::size_t _offset = 0;    ///< first free byte in the current chunk
+        };
+
+        /**
+        * @brief Resets an arena to where it was when the scope was entered.
+        */
+        class ArenaScope {
+        public:
+            explicit ArenaScope(Arena &arena = Arena::local()) : _arena(arena), _marker(arena.mark()) {}
+
+            ~ArenaScope() {
+                _arena.reset(_marker);
+            }
+
+            ArenaScope(const ArenaScope &) = delete;
+            ArenaScope &operator=(const ArenaScope &) = delete;
+
+            inline Arena &arena() {
+                return _arena;
+            }
+
+        private:
+            Arena &_arena;
+            Arena::Marker _marker;
+        };
+
+        /**
+        * @brief Scoped access to the calling thread's OpenSSL BIGNUM pool. BIGNUMs taken from the
+        *        scope are returned to the pool when it ends, and the pool keeps their storage.
+        */
+        class BignumScope {
+        public:
+            BignumScope();
+            ~BignumScope();
+
+            BignumScope(const BignumScope &) = delete;
+            BignumScope &operator=(const BignumScope &) = delete;
+
+            /// returns a zeroed BIGNUM valid until the scope ends, or NULL if OpenSSL is out of memory
+            BIGNUM *get();
+
+            /// returns the BN_CTX of the scope, for OpenSSL calls that take one
+            inline BN_CTX *ctx() {
+                return _ctx;
+            }
+
+        private:
+            BN_CTX *_ctx;
+        };
+
+    } // namespace memory
+}  // namespace halo2
+
+#endif  // HALO2_ARENA_H
@@ -0,0 +1,72 @@
+#include "../pch.h"
+
+using namespace std;
+
+namespace halo2 {
+    namespace memory {
+
+        static_assert(sizeof(crypto::Ciphertext) >= sizeof(void *), "free arrays store their link in place");
+
+        CiphertextPool::~CiphertextPool() {
+            for (auto &head : _free) {
+                while (head) {
+                    FreeArray *next = head->next;
+                    ::operator delete(static_cast<void *>(head));
+                    head = next;
+                }
+            }
+        }
+
+        unsigned CiphertextPool::sizeClass(size_t count) {
+            unsigned c = 0;
+            while ((size_t(1) << c) < count) {
+                c++;
+            }
+            return c;
+        }
+
+        crypto::Ciphertext *CiphertextPool::acquire(size_t count) {
+            unsigned c = sizeClass(count);
+            void *memory;
+            if (c < NUM_SIZE_CLASSES && _free[c]) {
+                memory = _free[c];
+                _free[c] = _free[c]->next;
+            } else if (c < NUM_SIZE_CLASSES) {
+                memory = ::operator new((size_t(1) << c) * sizeof(crypto::Ciphertext));
+            } else {
+                memory = ::operator new(count * sizeof(crypto::Ciphertext));
+            }
+            crypto::Ciphertext *array = static_cast<crypto::Ciphertext *>(memory);
+            for (size_t i = 0; i < count; i++) {
+                new (array + i) crypto::Ciphertext();
+            }
+            return array;
+        }
+
+        void CiphertextPool::release(crypto::Ciphertext *array, size_t count) {
+            unsigned c = sizeClass(count);
+            if (c >= NUM_SIZE_CLASSES) {
+                ::operator delete(static_cast<void *>(array));
+                return;
+            }
+            FreeArray *node = new (array) FreeArray{_free[c]};
+            _free[c] = node;
+        }
+
+        size_t CiphertextPool::freeArrays() const {
+            size_t total = 0;
+            for (const FreeArray *head : _free) {
+                for (; head; head = head->next) {
+                    total++;
+                }
+            }
+            return total;
+        }
+
+        CiphertextPool &CiphertextPool::local() {
+            static thread_local CiphertextPool pool;
+            return pool;
+        }
+
+    } // namespace memory
+}  // namespace halo2
@@ -0,0 +1,113 @@
+#ifndef HALO2_CIPHERTEXT_POOL_H
+#define HALO2_CIPHERTEXT_POOL_H
+
+namespace halo2 {
+    namespace memory {
+
+        /**
+        * @brief A pool of Ciphertext arrays in power of two size classes.
+        *
+        * Released arrays are kept on a free list per size class, threaded through the arrays
+        * themselves, and handed out again by the next acquire of the same class. The pool only
+        * touches the heap when a class has no free array.
+        *
+        * A pool is not thread-safe. The pool of local() belongs to its thread and is destroyed
+        * with it, so its arrays must be released on that thread.
+        */
+        class CiphertextPool {
+        public:
+            static constexpr unsigned NUM_SIZE_CLASSES = 48;
+
+            CiphertextPool() = default;
+            ~CiphertextPool();
+
+            CiphertextPool(const CiphertextPool &) = delete;
+            CiphertextPool &operator=(const CiphertextPool &) = delete;
+
+            /**
+            * @brief Takes an array of at least count zeroed ciphertexts from the pool.
+            *
+            * @param count The number of ciphertexts, greater than zero.
+            *
+            * @return The array, to be given back with release(array, count).
+            */
+            crypto::Ciphertext *acquire(std::size_t count);
+
+            /**
+            * @brief Gives an array back to the pool.
+            *
+            * @param array An array returned by acquire.
+            * @param count The count it was acquired with.
+            */
+            void release(crypto::Ciphertext *array, std::size_t count);
+
+            /// returns the number of arrays on the free lists
+            std::size_t freeArrays() const;
+
+            /// returns the pool of the calling thread
+            static CiphertextPool &local();
+
+        private:
+            struct FreeArray {
+                FreeArray *next;
+            };
+
+            static unsigned sizeClass(std::size_t count);
+
+            FreeArray *_free[NUM_SIZE_CLASSES] = {};
+        };
+
+        /**
+        * @brief An array of ciphertexts taken from a pool for the lifetime of the batch.
+        *
+        * The batch gives its array back to the pool when destroyed, which must happen on the
+        * thread that created it. Hand the ciphertexts to another thread by copying them out, not
+        * by moving the batch there.
+        */
+        class CiphertextBatch {
+        public:
+            explicit CiphertextBatch(std::size_t count, CiphertextPool &pool = CiphertextPool::local())
+                : _pool(pool), _count(count), _data(count ? pool.acquire(count) : NULL),
+                  _owner(std::this_thread::get_id()) {}
+
+            ~CiphertextBatch() {
+                assert(std::this_thread::get_id() == _owner && "CiphertextBatch released on another thread");
+                if (_data) {
+                    _pool.release(_data, _count);
+                }
+            }
+
+            CiphertextBatch(const CiphertextBatch &) = delete;
+            CiphertextBatch &operator=(const CiphertextBatch &) = delete;
+
+            inline crypto::Ciphertext *data() {
+                return _data;
+            }
+
+            inline std::size_t size() const {
+                return _count;
+            }
+
+            inline crypto::Ciphertext &operator[](std::size_t i) {
+                return _data[i];
+            }
+
+            inline crypto::Ciphertext *begin() {
+                return _data;
+            }
+
+            inline crypto::Ciphertext *end() {
+                return _data + _count;
+            }
+
+        private:
+            CiphertextPool &_pool;
+            std::size_t _count;
+            crypto::Ciphertext *_data;
+            std::thread::id _owner;     ///< the thread the batch must be destroyed on
+        };
+
+    } // namespace memory
+}  // namespace halo2
+
+#endif  // HALO2_CIPHERTEXT_POOL_H
@@ -13,6 +13,20 @@
 #include <iostream>
 #include <cmath>
 #include <variant>
+#include <array>
+#include <string>
+#include <algorithm>
+#include <thread>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <map>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <stdexcept>
+#include <cassert>
 
 using namespace std;
 
@@ -22,14 +36,27 @@ using namespace std;
 #include <openssl/bio.h>
 #include <openssl/evp.h>
 #include <openssl/rsa.h>
+#include <openssl/bn.h>
+#include <openssl/err.h>
+
+// boost
+#include <boost/multiprecision/cpp_int.hpp>
 
 
 #include "homomorphic/private_key.h"
 #include "homomorphic/public_key.h"
+#include "homomorphic/threshold_key.h"
 #include "homomorphic/cipher_text.h"
+#include "memory/arena.h"
+#include "memory/ciphertext_pool.h"
 #include "homomorphic/paillier_crypto_system.h"
+#include "homomorphic/threshold_transport.h"
+#include "homomorphic/threshold_paillier.h"
 
 #include "logger.hpp"
 #include "xorwow.h"
 
+#include "circuit/xorwow_circuit.h"
+#include "circuit/xorwow_witness.h"
+
 #endif //HALO2_PCH_H
@@ -22,7 +22,7 @@ xorwow::xorwow(uint64_t seed, halo2::crypto::PublicKey *pk) {
         PaillierCryptoSystem::encrypt(_pk, 0xdeadc0de, state.x[4]);
         PaillierCryptoSystem::encrypt(_pk, 0, state.counter);
     } else {
-        auto state = get<XORWOW_STATE>(_state);
+        auto &state = get<XORWOW_STATE>(_state);
         state.x[0] = seed & UINT32_MAX;
         state.x[1] = seed >> 32;
         state.x[2] = state.x[0] ^ 0xdeadbeef;
@@ -53,7 +53,7 @@ XRAND_VALUE xorwow::rand() {
         v = (t + state.counter);
 
     } else {
-        auto state = get<XORWOW_STATE>(_state);
+        auto &state = get<XORWOW_STATE>(_state);
         std::uint64_t t = state.x[4];
         const std::uint64_t s = state.x[0];
         state.x[4] = state.x[3];
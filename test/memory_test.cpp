@@ -0,0 +1,186 @@
+#include "pch.h"
+
+using namespace halo2::memory;
+
+namespace {
+    // counts the heap allocations made while counting is on
+    bool countAllocations = false;
+    size_t allocations = 0;
+}
+
+// kept out of line, otherwise GCC matches the inlined free against the new of each caller
+#ifdef __GNUC__
+#define NOINLINE __attribute__((noinline))
+#else
+#define NOINLINE
+#endif
+
+NOINLINE void *operator new(size_t size) {
+    if (countAllocations) {
+        allocations++;
+    }
+    void *p = malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+NOINLINE void operator delete(void *p) noexcept {
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    operator delete(p);
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete[](void *p) noexcept {
+    operator delete(p);
+}
+
+void operator delete[](void *p, size_t) noexcept {
+    operator delete(p);
+}
+
+namespace {
+    // primes small enough that every product in PaillierCryptoSystem stays below 2^64
+    const uint64_t P = 241;
+    const uint64_t Q = 251;
+
+    // PaillierCryptoSystem::decrypt computes L((y * x^-lambda)^mu), which is m for
+    // mu = lambda * k with k = -lambda^-2 mod n
+    PrivateKey privateKey() {
+        const uint64_t n = P * Q;
+        uint64_t lambda = PaillierCryptoSystem::lcm(P - 1, Q - 1);
+        uint64_t k = n - PaillierCryptoSystem::inv(lambda * lambda % n, n);
+        return PrivateKey(lambda, lambda * k);
+    }
+}
+
+TEST(ArenaTest, ResetReusesMemory) {
+    Arena arena(1024);
+    Arena::Marker start = arena.mark();
+
+    uint64_t *a = arena.allocateLimbs(16);
+    uint8_t *b = static_cast<uint8_t *>(arena.allocate(3, 1));
+    uint64_t *c = arena.allocateLimbs(4);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(c) % alignof(uint64_t), 0u);
+    EXPECT_GE(reinterpret_cast<uint8_t *>(c), b + 3);
+    EXPECT_GE(reinterpret_cast<uint64_t *>(b), a + 16);
+
+    arena.reset(start);
+    EXPECT_EQ(arena.allocateLimbs(16), a);
+}
+
+TEST(ArenaTest, GrowsAndKeepsChunks) {
+    Arena arena(256);
+    {
+        ArenaScope scope(arena);
+        for (int i = 0; i < 10; i++) {
+            arena.allocateLimbs(16);
+        }
+        // larger than a chunk
+        arena.allocateLimbs(100);
+    }
+    size_t capacity = arena.capacity();
+    EXPECT_GT(capacity, 256u);
+
+    {
+        ArenaScope scope(arena);
+        for (int i = 0; i < 10; i++) {
+            arena.allocateLimbs(16);
+        }
+        arena.allocateLimbs(100);
+    }
+    EXPECT_EQ(arena.capacity(), capacity);
+}
+
+TEST(CiphertextPoolTest, ReleasedArraysAreReused) {
+    CiphertextPool pool;
+    Ciphertext *a = pool.acquire(100);
+    a[99] = Ciphertext(1, 2);
+    pool.release(a, 100);
+    EXPECT_EQ(pool.freeArrays(), 1u);
+
+    // same size class
+    Ciphertext *b = pool.acquire(120);
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(b[99].x, 0u);
+    EXPECT_EQ(pool.freeArrays(), 0u);
+
+    {
+        CiphertextBatch batch(10, pool);
+        EXPECT_EQ(batch.size(), 10u);
+    }
+    EXPECT_EQ(pool.freeArrays(), 1u);
+    pool.release(b, 120);
+}
+
+#ifndef NDEBUG
+TEST(CiphertextPoolDeathTest, BatchReleasedOnAnotherThread) {
+    testing::FLAGS_gtest_death_test_style = "threadsafe";
+    EXPECT_DEATH({
+        CiphertextBatch *batch = new CiphertextBatch(4);
+        std::thread([batch]() { delete batch; }).join();
+    }, "another thread");
+}
+#endif
+
+TEST(CiphertextPoolTest, BatchMatchesSingleEncryption) {
+    PublicKey pk(P * Q, P * Q + 1);
+    uint64_t m[8] = {1, 2, 3, 5, 8, 13, 21, 34};
+
+    srand(7);
+    Ciphertext single[8];
+    for (int i = 0; i < 8; i++) {
+        single[i] = PaillierCryptoSystem::encrypt(pk, m[i]);
+    }
+
+    srand(7);
+    CiphertextBatch batch(8);
+    PaillierCryptoSystem::encrypt(pk, m, 8, batch.data());
+    for (int i = 0; i < 8; i++) {
+        EXPECT_EQ(batch[i].x, single[i].x);
+        EXPECT_EQ(batch[i].y, single[i].y);
+    }
+}
+
+TEST(CiphertextPoolTest, SteadyStateDoesNotAllocate) {
+    PublicKey pk(P * Q, P * Q + 1);
+    PrivateKey sk = privateKey();
+    const size_t count = 1000;
+    uint64_t m[count];
+    uint64_t decrypted[count];
+    for (size_t i = 0; i < count; i++) {
+        m[i] = i * 59 % pk.n;
+    }
+
+    auto hotLoop = [&]() {
+        CiphertextBatch batch(count);
+        PaillierCryptoSystem::encrypt(pk, m, count, batch.data());
+        PaillierCryptoSystem::decrypt(pk, sk, batch.data(), count, decrypted);
+    };
+
+    // warm up the thread's arena and pool
+    hotLoop();
+
+    allocations = 0;
+    countAllocations = true;
+    for (int i = 0; i < 100; i++) {
+        hotLoop();
+    }
+    countAllocations = false;
+    EXPECT_EQ(allocations, 0u);
+
+    CiphertextBatch batch(count);
+    PaillierCryptoSystem::encrypt(pk, m, count, batch.data());
+    PaillierCryptoSystem::decrypt(pk, sk, batch.data(), count, decrypted);
+    for (size_t i = 0; i < count; i++) {
+        EXPECT_EQ(PaillierCryptoSystem::decrypt(pk, sk, batch[i]), decrypted[i]) << "index " << i;
+        EXPECT_EQ(decrypted[i], m[i]) << "index " << i;
+    }
+}
@@ -0,0 +1,318 @@
+#include "pch.h"
+#define NUM_VALUES 1000
+
+// serves every node on its own thread and takes a fixed time per request, the requests to the
+// dead node are dropped
+class SlowTransport : public ThresholdTransport {
+public:
+    SlowTransport(const std::vector<ThresholdDecryptionNode *> &nodes, std::chrono::milliseconds delay,
+                  uint32_t dead = 0)
+        : _delay(delay), _dead(dead) {
+        for (ThresholdDecryptionNode *node : nodes) {
+            _workers.emplace_back(new Worker{node, {}, {}});
+        }
+        for (auto &worker : _workers) {
+            worker->thread = std::thread(&SlowTransport::run, this, std::ref(*worker));
+        }
+    }
+
+    ~SlowTransport() override {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _closed = true;
+        }
+        _ready.notify_all();
+        for (auto &worker : _workers) {
+            worker->thread.join();
+        }
+    }
+
+    std::vector<uint32_t> nodes() const override {
+        std::vector<uint32_t> indices;
+        for (const auto &worker : _workers) {
+            indices.push_back(worker->node->index());
+        }
+        return indices;
+    }
+
+    void send(uint32_t index, const PartialDecryptionRequest &request) override {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (index == _dead) {
+            deadRequests++;
+            return;
+        }
+        for (auto &worker : _workers) {
+            if (worker->node->index() == index) {
+                worker->requests.push_back(request);
+            }
+        }
+        _ready.notify_all();
+    }
+
+    ThresholdReceiveStatus receive(PartialDecryptionResponse &response, std::chrono::milliseconds timeout) override {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (!_ready.wait_for(lock, timeout, [this]() { return !_responses.empty(); })) {
+            return THRESHOLD_TIMED_OUT;
+        }
+        response = std::move(_responses.front());
+        _responses.pop_front();
+        return THRESHOLD_RECEIVED;
+    }
+
+    size_t deadRequests = 0;
+
+private:
+    struct Worker {
+        ThresholdDecryptionNode *node;
+        std::deque<PartialDecryptionRequest> requests;
+        std::thread thread;
+    };
+
+    void run(Worker &worker) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (true) {
+            _ready.wait(lock, [&]() { return _closed || !worker.requests.empty(); });
+            if (_closed) {
+                return;
+            }
+            PartialDecryptionRequest request = std::move(worker.requests.front());
+            worker.requests.pop_front();
+
+            lock.unlock();
+            std::this_thread::sleep_for(_delay);
+            PartialDecryptionResponse response = worker.node->handle(request);
+            lock.lock();
+            _responses.push_back(std::move(response));
+            _ready.notify_all();
+        }
+    }
+
+    std::chrono::milliseconds _delay;
+    uint32_t _dead;
+    std::mutex _mutex;
+    std::condition_variable _ready;
+    std::vector<std::unique_ptr<Worker>> _workers;
+    std::deque<PartialDecryptionResponse> _responses;
+    bool _closed = false;
+};
+
+class ThresholdPaillierTest : public testing::Test {
+protected:
+    // safe primes, small enough for the tests to run fast
+    static constexpr uint64_t p = 227;
+    static constexpr uint64_t q = 263;
+    static constexpr uint32_t threshold = 3;
+    static constexpr uint32_t parties = 5;
+
+    ThresholdPublicKey pk;
+    std::vector<KeyShare> shares;
+    std::vector<std::unique_ptr<ThresholdDecryptionNode>> nodes;
+    uint64_t plainText[NUM_VALUES];
+    Ciphertext cipherText[NUM_VALUES];
+
+public:
+    void SetUp() override {
+        ASSERT_TRUE(ThresholdDealer::splitKey(p, q, threshold, parties, pk, shares));
+        for (const auto &share : shares) {
+            nodes.emplace_back(new ThresholdDecryptionNode(pk, share));
+        }
+
+        PublicKey encryptKey = pk.publicKey();
+        srand(42);
+        for (uint64_t i = 0; i < NUM_VALUES; i++) {
+            plainText[i] = (i * 7919) % pk.n;
+            PaillierCryptoSystem::encrypt(encryptKey, plainText[i], cipherText[i]);
+        }
+    }
+
+    std::vector<ThresholdDecryptionNode *> nodeSubset(std::vector<uint32_t> indices) {
+        std::vector<ThresholdDecryptionNode *> subset;
+        for (uint32_t index : indices) {
+            subset.push_back(nodes[index - 1].get());
+        }
+        return subset;
+    }
+};
+
+TEST_F(ThresholdPaillierTest, InvalidParameters) {
+    ThresholdPublicKey key;
+    std::vector<KeyShare> keyShares;
+    EXPECT_FALSE(ThresholdDealer::splitKey(p, q, parties + 1, parties, key, keyShares));
+    EXPECT_FALSE(ThresholdDealer::splitKey(p, q, 0, parties, key, keyShares));
+    EXPECT_FALSE(ThresholdDealer::splitKey(p, p, threshold, parties, key, keyShares));
+    EXPECT_FALSE(ThresholdDealer::splitKey(5, 7, threshold, parties, key, keyShares));
+    EXPECT_FALSE(ThresholdDealer::generateKeys(threshold, parties, 32, key, keyShares));
+
+    // 4 * delta^2 shares the factor 3 with n
+    key = pk;
+    key.n = 3 * 5;
+    key.n2 = key.n * key.n;
+    InProcessTransport transport({});
+    EXPECT_THROW(ThresholdCombiner(key, transport), std::invalid_argument);
+}
+
+TEST_F(ThresholdPaillierTest, CombinesAnyThresholdSubset) {
+    InProcessTransport transport({});
+    ThresholdCombiner combiner(pk, transport);
+    const size_t count = 50;
+
+    std::vector<uint64_t> x(count);
+    for (size_t i = 0; i < count; i++) {
+        x[i] = cipherText[i].x;
+    }
+
+    for (uint32_t a = 1; a <= parties; a++) {
+        for (uint32_t b = a + 1; b <= parties; b++) {
+            for (uint32_t c = b + 1; c <= parties; c++) {
+                std::vector<PartialDecryptionResponse> responses(3);
+                std::vector<const PartialDecryptionResponse *> partials;
+                uint32_t indices[3] = {c, a, b};
+                for (int j = 0; j < 3; j++) {
+                    responses[j].index = indices[j];
+                    responses[j].indices = {a, b, c};
+                    responses[j].partials.resize(count);
+                    ASSERT_TRUE(nodes[indices[j] - 1]->partialDecrypt(responses[j].indices, x.data(), count,
+                                                                      responses[j].partials.data()));
+                    partials.push_back(&responses[j]);
+                }
+
+                uint64_t decrypted[count];
+                ASSERT_TRUE(combiner.combine(partials, count, decrypted));
+                for (size_t i = 0; i < count; i++) {
+                    EXPECT_EQ(decrypted[i], plainText[i]) << "Shares " << a << b << c << " index " << i;
+                }
+            }
+        }
+    }
+    EXPECT_EQ(combiner.cachedCoefficients(), 10u);
+
+    std::vector<PartialDecryptionResponse> responses(threshold + 1);
+    for (uint32_t j = 0; j <= threshold; j++) {
+        responses[j].index = j + 1;
+        responses[j].indices = {1, 2, j < threshold ? 3u : 4u};
+        responses[j].partials.resize(count);
+        ASSERT_TRUE(nodes[j]->partialDecrypt(responses[j].indices, x.data(), count, responses[j].partials.data()));
+    }
+    uint64_t decrypted[count];
+    // partials of two different node sets
+    EXPECT_FALSE(combiner.combine({&responses[0], &responses[1], &responses[3]}, count, decrypted));
+    responses[3].indices = {1, 2, 4};
+    EXPECT_FALSE(combiner.combine({&responses[0], &responses[1]}, count, decrypted));
+    EXPECT_FALSE(combiner.combine({&responses[0], &responses[1], &responses[2], &responses[3]}, count, decrypted));
+    EXPECT_FALSE(combiner.combine({&responses[0], &responses[1], &responses[1]}, count, decrypted));
+    EXPECT_FALSE(combiner.combine({&responses[0], &responses[1], &responses[2]}, count + 1, decrypted));
+    responses[2].index = parties + 1;
+    EXPECT_FALSE(combiner.combine({&responses[0], &responses[1], &responses[2]}, count, decrypted));
+    responses[2].index = 0;
+    EXPECT_FALSE(combiner.combine({&responses[0], &responses[1], &responses[2]}, count, decrypted));
+    EXPECT_EQ(combiner.cachedCoefficients(), 10u);
+
+    // a node only answers for valid sets it belongs to
+    EXPECT_FALSE(nodes[0]->partialDecrypt({2, 3, 4}, x.data(), count, decrypted));
+    EXPECT_FALSE(nodes[0]->partialDecrypt({1, 2}, x.data(), count, decrypted));
+    EXPECT_FALSE(nodes[0]->partialDecrypt({2, 1, 3}, x.data(), count, decrypted));
+    EXPECT_FALSE(nodes[0]->partialDecrypt({1, 2, parties + 1}, x.data(), count, decrypted));
+}
+
+TEST_F(ThresholdPaillierTest, DecryptsThroughTransport) {
+    InProcessTransport transport(nodeSubset({1, 2, 3, 4, 5}));
+    ThresholdCombiner combiner(pk, transport, 64);
+
+    uint64_t decrypted[NUM_VALUES];
+    ASSERT_TRUE(combiner.decrypt(cipherText, NUM_VALUES, decrypted));
+    for (size_t i = 0; i < NUM_VALUES; i++) {
+        EXPECT_EQ(decrypted[i], plainText[i]) << "Decrypted value of index " << i << " doesn't match";
+    }
+    // one node set per rotation
+    EXPECT_EQ(combiner.cachedCoefficients(), parties);
+
+    // the rotation carries on across calls, single batch calls go round every node set
+    ThresholdCombiner single(pk, transport, 64);
+    for (size_t call = 1; call <= parties; call++) {
+        ASSERT_TRUE(single.decrypt(cipherText, 64, decrypted));
+        EXPECT_EQ(single.cachedCoefficients(), call);
+    }
+    ASSERT_TRUE(single.decrypt(cipherText, 64, decrypted));
+    EXPECT_EQ(single.cachedCoefficients(), parties);
+}
+
+TEST_F(ThresholdPaillierTest, ResendsAroundDeadNode) {
+    uint64_t decrypted[NUM_VALUES];
+    {
+        SlowTransport transport(nodeSubset({1, 2, 3, 4, 5}), std::chrono::milliseconds(0), 2);
+        ThresholdCombiner combiner(pk, transport, 64, std::chrono::milliseconds(50));
+        ASSERT_TRUE(combiner.decrypt(cipherText, NUM_VALUES, decrypted));
+        for (size_t i = 0; i < NUM_VALUES; i++) {
+            EXPECT_EQ(decrypted[i], plainText[i]) << "Decrypted value of index " << i << " doesn't match";
+        }
+        // 10 of the 16 batches rotate onto node 2 before the first timeout, it is not asked again
+        EXPECT_EQ(transport.deadRequests, 10u);
+    }
+    {
+        // the two other nodes cannot make up for the dead one
+        SlowTransport transport(nodeSubset({1, 2, 4}), std::chrono::milliseconds(0), 4);
+        ThresholdCombiner combiner(pk, transport, 64, std::chrono::milliseconds(50));
+        EXPECT_FALSE(combiner.decrypt(cipherText, NUM_VALUES, decrypted));
+    }
+}
+
+TEST_F(ThresholdPaillierTest, SlowNodesWorkThroughBacklog) {
+    // every node queues 125 batches of 10 ms, well past the timeout in total
+    SlowTransport transport(nodeSubset({1, 3, 5}), std::chrono::milliseconds(10));
+    ThresholdCombiner combiner(pk, transport, 8);
+
+    uint64_t decrypted[NUM_VALUES];
+    ASSERT_TRUE(combiner.decrypt(cipherText, NUM_VALUES, decrypted));
+    for (size_t i = 0; i < NUM_VALUES; i++) {
+        EXPECT_EQ(decrypted[i], plainText[i]) << "Decrypted value of index " << i << " doesn't match";
+    }
+    EXPECT_EQ(combiner.cachedCoefficients(), 1u);
+}
+
+TEST_F(ThresholdPaillierTest, NeedsThresholdNodes) {
+    uint64_t decrypted[NUM_VALUES];
+    {
+        InProcessTransport transport(nodeSubset({2, 4, 5}));
+        ThresholdCombiner combiner(pk, transport, 100);
+        ASSERT_TRUE(combiner.decrypt(cipherText, NUM_VALUES, decrypted));
+        for (size_t i = 0; i < NUM_VALUES; i++) {
+            EXPECT_EQ(decrypted[i], plainText[i]);
+        }
+    }
+    {
+        InProcessTransport transport(nodeSubset({1, 3}));
+        ThresholdCombiner combiner(pk, transport, 100);
+        EXPECT_FALSE(combiner.decrypt(cipherText, NUM_VALUES, decrypted));
+    }
+}
+
+TEST_F(ThresholdPaillierTest, GeneratedKeyRoundTrip) {
+    for (int primeBits : {ThresholdDealer::MIN_PRIME_BITS, ThresholdDealer::MAX_PRIME_BITS}) {
+        ThresholdPublicKey key;
+        std::vector<KeyShare> keyShares;
+        ASSERT_TRUE(ThresholdDealer::generateKeys(2, 3, primeBits, key, keyShares));
+        ASSERT_EQ(keyShares.size(), 3u);
+
+        std::vector<std::unique_ptr<ThresholdDecryptionNode>> keyNodes;
+        for (const auto &share : keyShares) {
+            keyNodes.emplace_back(new ThresholdDecryptionNode(key, share));
+        }
+        InProcessTransport transport({keyNodes[0].get(), keyNodes[1].get(), keyNodes[2].get()});
+        ThresholdCombiner combiner(key, transport, 8);
+
+        const size_t count = 64;
+        PublicKey encryptKey = key.publicKey();
+        uint64_t m[count];
+        halo2::memory::CiphertextBatch ct(count);
+        for (size_t i = 0; i < count; i++) {
+            m[i] = (i * 0x9e3779b97f4a7c15ull) % key.n;
+        }
+        PaillierCryptoSystem::encrypt(encryptKey, m, count, ct.data());
+
+        uint64_t decrypted[count];
+        ASSERT_TRUE(combiner.decrypt(ct.data(), count, decrypted));
+        for (size_t i = 0; i < count; i++) {
+            EXPECT_EQ(decrypted[i], m[i]) << primeBits << "-bit primes, index " << i;
+        }
+    }
+}
@@ -0,0 +1,196 @@
+#include "pch.h"
+
+using namespace halo2::circuit;
+
+class XorwowCircuitTest : public testing::Test {
+protected:
+    static constexpr uint64_t seed = 0xc0defeeddeadbeef;
+    XorwowTrace trace;
+};
+
+TEST_F(XorwowCircuitTest, WitnessMatchesXorwow) {
+    const size_t steps = 1000;
+    XorwowWitnessGenerator::generate(seed, steps, trace, 1);
+    ASSERT_EQ(trace.rows, steps);
+
+    xorwow rng(seed);
+    for (size_t row = 0; row < steps; row++) {
+        uint64_t expected = get<uint64_t>(rng.rand());
+        ASSERT_EQ(trace.at(XORWOW_COL_OUT, row), expected) << "Output of step " << row << " doesn't match";
+    }
+}
+
+TEST_F(XorwowCircuitTest, ParallelWitnessMatchesSequential) {
+    const size_t steps = 2 * XorwowWitnessGenerator::MIN_PARALLEL_STEPS + 123;
+    XorwowTrace sequential;
+    XorwowWitnessGenerator::generate(seed, steps, sequential, 1);
+    XorwowWitnessGenerator::generate(seed, steps, trace, 4);
+
+    for (size_t c = 0; c < XORWOW_NUM_COLUMNS; c++) {
+        EXPECT_TRUE(trace.columns[c] == sequential.columns[c])
+            << "Column " << XorwowCircuit::columnName(static_cast<XorwowColumn>(c)) << " doesn't match";
+    }
+    for (size_t c = 0; c < trace.limbs.size(); c++) {
+        EXPECT_TRUE(trace.limbs[c] == sequential.limbs[c]) << "Limb column " << c << " doesn't match";
+    }
+}
+
+TEST_F(XorwowCircuitTest, JumpMatchesTrace) {
+    XorwowWitnessGenerator::generate(seed, 5000, trace, 1);
+    XORWOW_STATE start = XorwowWitnessGenerator::initialState(seed);
+
+    for (size_t row : {0, 1, 2, 1000, 4999}) {
+        XORWOW_STATE state = XorwowWitnessGenerator::jump(start, row);
+        for (unsigned i = 0; i < 5; i++) {
+            EXPECT_EQ(state.x[i], trace.at(static_cast<XorwowColumn>(XORWOW_COL_X0 + i), row));
+        }
+        EXPECT_EQ(state.counter, trace.at(XORWOW_COL_COUNTER, row));
+    }
+}
+
+TEST_F(XorwowCircuitTest, WitnessSatisfiesCircuit) {
+    XorwowWitnessGenerator::generate(seed, 2000, trace);
+    XorwowInstance instance(seed, trace.columns[XORWOW_COL_OUT]);
+
+    std::string failure;
+    EXPECT_TRUE(XorwowCircuit::verify(trace, instance, &failure)) << failure;
+
+    instance.outputs.pop_back();
+    EXPECT_FALSE(XorwowCircuit::verify(trace, instance, &failure));
+}
+
+TEST_F(XorwowCircuitTest, WitnessIsBoundToInstance) {
+    XorwowWitnessGenerator::generate(seed, 100, trace);
+    XorwowInstance instance(seed, trace.columns[XORWOW_COL_OUT]);
+    std::string failure;
+
+    // a consistent trace of an unrelated seed
+    XorwowTrace other;
+    XorwowWitnessGenerator::generate(seed + 1, 100, other);
+    EXPECT_FALSE(XorwowCircuit::verify(other, instance, &failure));
+    EXPECT_EQ(failure, "init_x0 at row 0");
+
+    // shifting every counter and output keeps all the per-row gates satisfied
+    for (size_t row = 0; row < trace.rows; row++) {
+        trace.at(XORWOW_COL_COUNTER, row) += 1000;
+        trace.at(XORWOW_COL_COUNTER_NEXT, row) += 1000;
+        trace.at(XORWOW_COL_OUT, row) += 1000;
+        trace.decompose(row);
+    }
+    EXPECT_FALSE(XorwowCircuit::verify(trace, instance, &failure));
+    EXPECT_EQ(failure, "init_counter at row 0");
+
+    XorwowInstance shifted = instance;
+    shifted.initialState[5] += 1000;
+    EXPECT_FALSE(XorwowCircuit::verify(trace, shifted, &failure));
+    EXPECT_EQ(failure, "out_instance at row 0");
+}
+
+TEST_F(XorwowCircuitTest, TamperedWitnessFails) {
+    XorwowWitnessGenerator::generate(seed, 100, trace);
+    XorwowInstance instance(seed, trace.columns[XORWOW_COL_OUT]);
+    std::string failure;
+
+    trace.at(XORWOW_COL_T2, 42) ^= 0x100;
+    EXPECT_FALSE(XorwowCircuit::verify(trace, instance, &failure));
+    EXPECT_EQ(failure, "t2_limbs at row 42");
+    trace.decompose(42);
+    EXPECT_FALSE(XorwowCircuit::verify(trace, instance, &failure));
+    EXPECT_EQ(failure, "t2 = t1 ^ (t1 << 1) at row 42");
+    trace.at(XORWOW_COL_T2, 42) ^= 0x100;
+    trace.decompose(42);
+
+    trace.at(XORWOW_COL_X2, 17) += 1;
+    EXPECT_FALSE(XorwowCircuit::verify(trace, instance, &failure));
+    EXPECT_EQ(failure, "next_x2 at row 16");
+    trace.at(XORWOW_COL_X2, 17) -= 1;
+
+    // a limb that no longer matches its cell
+    trace.limb(XORWOW_COL_OUT, 0, 5) += 1;
+    EXPECT_FALSE(XorwowCircuit::verify(trace, instance, &failure));
+    EXPECT_EQ(failure, "out_limbs at row 5");
+    trace.decompose(5);
+
+    ASSERT_TRUE(XorwowCircuit::verify(trace, instance, &failure)) << failure;
+}
+
+TEST_F(XorwowCircuitTest, RemainderRangeCheckFails) {
+    XorwowWitnessGenerator::generate(seed, 100, trace);
+    const size_t row = trace.rows - 1;
+    ASSERT_GT(trace.at(XORWOW_COL_T_SHR2, row), 0u);
+
+    // t = (t >> 2 - 1) * 4 + (rem + 4) satisfies the decomposition gate with a 3-bit remainder.
+    // Every derived cell is recomputed from the forged t >> 2 so that all the XOR lookups and
+    // gates still hold, on the last row there is no next state to contradict t3.
+    trace.at(XORWOW_COL_T_SHR2_REM, row) += 4;
+    uint64_t shr2 = --trace.at(XORWOW_COL_T_SHR2, row);
+    uint64_t t1 = trace.at(XORWOW_COL_X4, row) ^ shr2;
+    uint64_t t2 = t1 ^ (t1 << 1);
+    uint64_t t3 = t2 ^ trace.at(XORWOW_COL_U, row);
+    uint64_t out = t3 + trace.at(XORWOW_COL_COUNTER_NEXT, row);
+    trace.at(XORWOW_COL_T1, row) = t1;
+    trace.at(XORWOW_COL_T1_SHL1, row) = t1 << 1;
+    trace.at(XORWOW_COL_T1_SHL1_HI, row) = t1 >> 63;
+    trace.at(XORWOW_COL_T2, row) = t2;
+    trace.at(XORWOW_COL_T3, row) = t3;
+    trace.at(XORWOW_COL_OUT, row) = out;
+    trace.at(XORWOW_COL_OUT_CARRY, row) = out < t3;
+    trace.decompose(row);
+
+    XorwowInstance instance(seed, trace.columns[XORWOW_COL_OUT]);
+    std::string failure;
+    EXPECT_FALSE(XorwowCircuit::verify(trace, instance, &failure));
+    EXPECT_EQ(failure, "t_shr2_rem at row " + std::to_string(row));
+}
+
+TEST_F(XorwowCircuitTest, ForgedShiftBitsFail) {
+    typedef XorwowGateValue V;
+    const V &q = XorwowCircuit::modulus();
+    XorwowWitnessGenerator::generate(seed, 1000, trace);
+
+    // recomputes the cells downstream of t1 << 1 and s << 4 on the last row, which no later row checks
+    auto forgeLastRow = [&](uint64_t t1Shl1, uint64_t sShl4) {
+        const size_t row = trace.rows - 1;
+        uint64_t t2 = trace.at(XORWOW_COL_T1, row) ^ t1Shl1;
+        uint64_t u = trace.at(XORWOW_COL_X0, row) ^ sShl4;
+        uint64_t t3 = t2 ^ u;
+        uint64_t out = t3 + trace.at(XORWOW_COL_COUNTER_NEXT, row);
+        trace.at(XORWOW_COL_T1_SHL1, row) = t1Shl1;
+        trace.at(XORWOW_COL_T2, row) = t2;
+        trace.at(XORWOW_COL_S_SHL4, row) = sShl4;
+        trace.at(XORWOW_COL_U, row) = u;
+        trace.at(XORWOW_COL_T3, row) = t3;
+        trace.at(XORWOW_COL_OUT, row) = out;
+        trace.at(XORWOW_COL_OUT_CARRY, row) = out < t3;
+        trace.decompose(row);
+    };
+    std::string failure;
+
+    // hi = 2^-7 puts 2^56 where 2^63 belongs, t1 << 1 becomes 2 * t1 - 2^57
+    size_t row = 0;
+    while (trace.at(XORWOW_COL_T1, row) < (uint64_t(1) << 56) || trace.at(XORWOW_COL_T1, row) >> 63) {
+        row++;
+    }
+    trace.resize(row + 1);
+    V hi = V(boost::multiprecision::powm(V(128), V(q - 2), q));
+    trace.assign(XORWOW_COL_T1_SHL1_HI, row, hi);
+    forgeLastRow(2 * trace.at(XORWOW_COL_T1, row) - (uint64_t(1) << 57), trace.at(XORWOW_COL_S_SHL4, row));
+    EXPECT_EQ((hi * 128) % q, 1);
+    EXPECT_FALSE(XorwowCircuit::verify(trace, XorwowInstance(seed, trace.columns[XORWOW_COL_OUT]), &failure));
+    EXPECT_EQ(failure, "t1_shl1_hi_bool at row " + std::to_string(row));
+
+    // hi = (16 * (s >> 60) - 1) / 16 passes the scaled lookup alone and makes s << 4 one 2^60 larger
+    XorwowWitnessGenerator::generate(seed, 1000, trace);
+    row = 0;
+    while (trace.at(XORWOW_COL_S_SHL4_HI, row) == 0 || trace.at(XORWOW_COL_S_SHL4, row) >> 60 == 0xf) {
+        row++;
+    }
+    trace.resize(row + 1);
+    V k = 16 * V(trace.at(XORWOW_COL_S_SHL4_HI, row)) - 1;
+    hi = V(k * V(boost::multiprecision::powm(V(16), V(q - 2), q))) % q;
+    trace.assign(XORWOW_COL_S_SHL4_HI, row, hi);
+    forgeLastRow(trace.at(XORWOW_COL_T1_SHL1, row), trace.at(XORWOW_COL_S_SHL4, row) + (uint64_t(1) << 60));
+    EXPECT_EQ(hi * 16 % q, k);
+    EXPECT_FALSE(XorwowCircuit::verify(trace, XorwowInstance(seed, trace.columns[XORWOW_COL_OUT]), &failure));
+    EXPECT_EQ(failure, "s_shl4_hi at row " + std::to_string(row));
+}